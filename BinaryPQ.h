@@ -5,19 +5,38 @@
 
 #include <utility>
 #include <algorithm>
+#include <queue>
 #include "Eecs281PQ.h"
+#include "FindExtreme.h"
+#include "PQParallel.h"
 
 // A specialized version of the 'heap' ADT implemented as a binary heap.
+//
+// New elements are not fixed up right away: push() and pushRange() append
+// them to an insertion buffer at the back of 'data', and the next top() or
+// pop() merges the whole buffer into the heap at once (see flush()).  Loading
+// n elements before the first pop is therefore O(n), as with the range
+// constructor, instead of O(n log(n)).  Like UnorderedFastPQ, this means the
+// const top() may have to change the heap, hence the mutable members.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class BinaryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class BinaryPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
 public:
+    // How pop() restores the heap after the root is removed.
+    //   TopDown:  put the last element at the root and fix it down, which takes
+    //             two comparisons per level.
+    //   BottomUp: walk the hole at the root down to a leaf along the more
+    //             extreme children (one comparison per level), then fix the last
+    //             element up from there.  It rarely goes up far, so this needs
+    //             about half the comparisons; best for expensive comparators.
+    enum class PopMode { TopDown, BottomUp };
+
     // Description: Construct an empty heap with an optional comparison functor.
     // Runtime: O(1)
     explicit BinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp } {
+        BaseClass{ comp }, heapSize{ 0 }, popMode{ PopMode::TopDown } {
 
     } // BinaryPQ
 
@@ -28,7 +47,7 @@ public:
     // TODO: when you implement this function, uncomment the parameter names.
     template<typename InputIterator>
     BinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, data{start, end} {
+        BaseClass{ comp }, data{start, end}, heapSize{ 0 }, popMode{ PopMode::TopDown } {
             updatePriorities();
     } // BinaryPQ
 
@@ -41,9 +60,23 @@ public:
 
     // Description: Assumes that all elements inside the heap are out of order and
     //              'rebuilds' the heap by fixing the heap invariant.
-    // Runtime: O(n)
+    //              With pqThreadCount() > 1, see parallelHeapify().
+    //              If markDirty() was called since the last rebuild, only the
+    //              marked elements are assumed to be out of order; see
+    //              repairDirty().
+    // Runtime: O(n), or O(k log^2(n)) for k marked elements
     virtual void updatePriorities() {
-        for(size_t i = data.size(); i != 0; --i) {
+        if(!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), heapSize, 2)) {
+            repairDirty();
+            return;
+        }
+        dirty.clear();
+        heapSize = data.size();
+        if(pqThreadCount() > 1 && data.size() >= PQ_PARALLEL_MIN) {
+            parallelHeapify();
+            return;
+        }
+        for(size_t i = data.size() / 2; i != 0; --i) {
             fix_down(i);
         }
         
@@ -51,13 +84,41 @@ public:
 
 
     // Description: Add a new element to the heap.
-    // Runtime: O(log(n))
+    // Runtime: O(1) amortized; the next top() or pop() pays O(log(n)) for it.
     // TODO: when you implement this function, uncomment the parameter names.
     virtual void push(const TYPE &val) {
         data.push_back(val);
-        fix_up(data.size());
     } // push()
 
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed in place.
+    // Runtime: O(1) amortized, as with push()
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+    } // emplace()
+
+
+    // Description: Add every element of a range to the heap.
+    // Runtime: O(k) for k elements; the next top() or pop() merges them in
+    //          O(k + log(n)^2), which is O(n + k) when k is large.
+    template<typename InputIterator>
+    void pushRange(InputIterator start, InputIterator end) {
+        data.insert(data.end(), start, end);
+    } // pushRange()
+
+
+    // Description: Make room for n elements in total, so that pushing up to
+    //              that many does not reallocate.
+    // Runtime: O(n)
+    void reserve(std::size_t n) {
+        data.reserve(n);
+    } // reserve()
+
 
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
@@ -66,19 +127,102 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     // Runtime: O(log(n))
     virtual void pop() {
-        std::swap(data[0], data.back());
+        flush();
+        if(popMode == PopMode::BottomUp && data.size() > 1) {
+            TYPE last = std::move(data.back());
+            data.pop_back();
+            size_t k = 1;
+            while(2 * k <= data.size()) {
+                size_t j = 2 * k;
+                if(j < data.size() && this->compare(get_element(j), get_element(j + 1))) ++j;
+                get_element(k) = std::move(get_element(j));
+                k = j;
+            }
+            while(k > 1 && this->compare(get_element(k/2), last)) {
+                get_element(k) = std::move(get_element(k/2));
+                k /= 2;
+            }
+            get_element(k) = std::move(last);
+            heapSize = data.size();
+            return;
+        }
+        // The root is thrown away, so the last element can simply be moved
+        // over it before fixing down.
+        if(data.size() > 1) {
+            data.front() = std::move(data.back());
+        }
         data.pop_back();
+        heapSize = data.size();
         fix_down(1);
-        // call fix_down
     } // pop()
 
 
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first.  For k below a quarter of the heap this
+    //              is k pops.  Past that it is cheaper to select the k
+    //              elements in one pass, as UnorderedPQ does, and heapify what
+    //              is left: O(n + k log(k)) instead of O(k log(n)), but with a
+    //              larger constant, so it only wins for large k.
+    // Runtime: O(k log(n)), or O(n + k log(k)) when 4k >= n
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        flush();
+        k = std::min(k, data.size());
+        if(4 * k < data.size()) {
+            for(; k != 0; --k) {
+                *out++ = std::move(data.front());
+                pop();
+            }
+            return out;
+        }
+        out = popExtremes(data, k, this->compare, out);
+        dirty.clear();
+        updatePriorities();
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Record that the element at 'position' (an offset from
+    //              begin()) has changed priority, for the next
+    //              updatePriorities().  Mark every changed element before
+    //              calling anything else on the heap.
+    // Runtime: O(1)
+    void markDirty(std::size_t position) {
+        dirty.push_back(position);
+    } // markDirty()
+
+
+    // Description: The elements in no particular order, so that markDirty()
+    //              has positions to refer to.
+    // Runtime: O(1)
+    typename std::vector<TYPE>::const_iterator begin() const {
+        return data.begin();
+    } // begin()
+
+    typename std::vector<TYPE>::const_iterator end() const {
+        return data.end();
+    } // end()
+
+
+    // Description: Choose how pop() fixes the heap; see PopMode above.
+    // Runtime: O(1)
+    void setPopMode(PopMode mode) {
+        popMode = mode;
+    } // setPopMode()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the heap.  This should be a reference for speed.  It MUST be
     //              const because we cannot allow it to be modified, as that
     //              might make it no longer be the most extreme element.
-    // Runtime: O(1)
+    // Runtime: O(1), after merging any elements pushed since the last top() or
+    //          pop()
     virtual const TYPE &top() const {
+        flush();
         return data.front();
     } // top()
 
@@ -99,31 +243,137 @@ public:
 
 private:
     // Note: This vector *must* be used for your heap implementation.
-    std::vector<TYPE> data;
-    // NOTE: You are not allowed to add any member variables.  You don't need
-    //       a "heapSize", since you can call your own size() member function,
-    //       or check data.size().
-
-    void fix_up(size_t k) {
-        while(k > 1 && this->compare(get_element(k/2), get_element(k))) {
-            std::swap(get_element(k), get_element(k/2));
+    // data[0, heapSize) is the heap, the rest is the insertion buffer.
+    mutable std::vector<TYPE> data;
+    mutable std::size_t heapSize;
+    PopMode popMode;
+    // Positions passed to markDirty() since the last updatePriorities().
+    std::vector<std::size_t> dirty;
+
+    // Floyd's heapify restricted to the marked elements and their ancestors:
+    // every other node's subtree is untouched, so fixing those nodes down in
+    // decreasing index order restores the heap.  A max-heap of 1-based
+    // indices hands them out in that order, and duplicates come out together.
+    // Marked elements still in the insertion buffer need nothing, since
+    // flush() places them by their current priorities.
+    void repairDirty() {
+        std::priority_queue<size_t> pending;
+        for(size_t position : dirty) {
+            if(position < heapSize) {
+                pending.push(position + 1);
+            }
+        }
+        dirty.clear();
+        size_t done = 0;
+        while(!pending.empty()) {
+            size_t k = pending.top();
+            pending.pop();
+            if(k == done) {
+                continue;
+            }
+            done = k;
+            fix_down(k, heapSize);
+            if(k > 1) {
+                pending.push(k / 2);
+            }
+        }
+    }
+
+    // Merge the insertion buffer into the heap.  A few elements are simply
+    // fixed up one at a time.  Otherwise this is Floyd's heapify restricted to
+    // the ancestors of the new elements: the parents of the buffer form one
+    // contiguous range of indices, their parents the next, and so on up to the
+    // root.  Fixing those down in decreasing index order is O(k) for the
+    // lowest ranges plus O(log(n)) for each of the O(log(n)) ranges above
+    // them, and with a buffer as large as the heap it is a full heapify.
+    void flush() const {
+        std::size_t k = data.size() - heapSize;
+        if(k == 0) {
+            return;
+        }
+        std::size_t levels = 0;
+        while((std::size_t{ 1 } << levels) <= heapSize) {
+            ++levels;
+        }
+        if(k <= levels) {
+            while(heapSize < data.size()) {
+                fix_up(++heapSize);
+            }
+            return;
+        }
+        std::size_t lo = (heapSize + 1) / 2;
+        std::size_t hi = data.size() / 2;
+        heapSize = data.size();
+        while(hi != 0) {
+            lo = std::max(lo, std::size_t{ 1 });
+            for(std::size_t i = hi; i >= lo; --i) {
+                fix_down(i);
+            }
+            hi = std::min(hi / 2, lo - 1);
+            lo /= 2;
+        }
+    }
+
+    // Floyd's heapify, split between threads.  The subtrees under the nodes
+    // of one level are disjoint, and the descendants of a contiguous run of
+    // nodes at any depth below are contiguous too, so each thread heapifies
+    // the subtrees of its own run of roots bottom-up.  The few levels above
+    // the roots are then fixed on this thread.
+    void parallelHeapify() const {
+        size_t parts = pqThreadCount();
+        size_t level = 0;
+        while((size_t{ 1 } << level) < 4 * parts && (size_t{ 2 } << level) <= data.size() / 2) {
+            ++level;
+        }
+        size_t roots = size_t{ 1 } << level;
+        parallelFor(roots, parts, [this, roots](size_t begin, size_t end) {
+            size_t depth = 0;
+            while(((roots + begin) << (depth + 1)) <= data.size() / 2) {
+                ++depth;
+            }
+            for(size_t d = depth + 1; d != 0; --d) {
+                size_t lo = (roots + begin) << (d - 1);
+                size_t hi = std::min(((roots + end) << (d - 1)) - 1, data.size() / 2);
+                for(size_t i = hi; i >= lo; --i) {
+                    fix_down(i);
+                }
+            }
+        });
+        for(size_t i = roots - 1; i != 0; --i) {
+            fix_down(i);
+        }
+    }
+
+    // Both fixes carry the moving element in a temporary and shift the others
+    // into the hole, which is one move per level instead of a three-move swap.
+    void fix_up(size_t k) const {
+        TYPE moving = std::move(get_element(k));
+        while(k > 1 && this->compare(get_element(k/2), moving)) {
+            get_element(k) = std::move(get_element(k/2));
             k /= 2;
         }
+        get_element(k) = std::move(moving);
     }
-    void fix_down(size_t k) {
-        while(2 * k <= data.size()) {
+    void fix_down(size_t k) const {
+        fix_down(k, data.size());
+    }
+    // Fixes down within the first n elements only.
+    void fix_down(size_t k, size_t n) const {
+        if(2 * k > n) return;
+        TYPE moving = std::move(get_element(k));
+        while(2 * k <= n) {
             size_t j = 2 * k;
-            if(j < data.size() && this->compare(get_element(j), get_element(j+1))) ++j;
-            if(!(this->compare(get_element(k), get_element(j)))) break;
-            std::swap(get_element(k), get_element(j));
+            if(j < n && this->compare(get_element(j), get_element(j+1))) ++j;
+            if(!(this->compare(moving, get_element(j)))) break;
+            get_element(k) = std::move(get_element(j));
             k = j;
         }
+        get_element(k) = std::move(moving);
     }
-    // Translation of 0-based indexing to 1-based indexing
-    const TYPE &get_element(size_t i) const {
-        return data[i - 1];
-    }
-    TYPE &get_element(size_t i) {
+    // Translation of 0-based indexing to 1-based indexing.  Since 'data' is
+    // mutable this hands out a modifiable element even from const members,
+    // so that flush() can use fix_up() and fix_down().
+    TYPE &get_element(size_t i) const {
         return data[i - 1];
     }
 }; // BinaryPQ
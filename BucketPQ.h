@@ -0,0 +1,406 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef BUCKETPQ_H
+#define BUCKETPQ_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Eecs281PQ.h"
+#include "PQBits.h"
+
+// The key of an element of a BucketPQ: the element itself for integers, and
+// the first member of a std::pair.  Use any other functor that returns an
+// integer for other elements.
+template<typename TYPE>
+struct BucketKey {
+    TYPE operator()(const TYPE &val) const {
+        return val;
+    }
+}; // BucketKey
+
+template<typename KEY, typename PAYLOAD>
+struct BucketKey<std::pair<KEY, PAYLOAD>> {
+    KEY operator()(const std::pair<KEY, PAYLOAD> &val) const {
+        return val.first;
+    }
+}; // BucketKey
+
+
+// BucketPQ needs to know which end of the key range is the most extreme.
+// The comparator must order elements by key, either like std::less (the
+// largest key is most extreme, the default everywhere in Eecs281PQ) or as
+// std::greater (the smallest key is).
+template<typename COMP_FUNCTOR>
+struct BucketSmallestFirst : std::false_type {};
+
+template<typename T>
+struct BucketSmallestFirst<std::greater<T>> : std::true_type {};
+
+
+// A set of bucket numbers with O(1) insert, erase and find-first, as a tree
+// of 64-bit words: bit i of level 0 is set if bucket i is not empty, and bit
+// j of level l + 1 is set if word j of level l is not zero.  Finding the
+// first bucket takes one count-trailing-zeros per level, and four levels
+// already cover 16M buckets.
+class BucketBitmap {
+public:
+    // Description: Make room for buckets [0, n), all empty.
+    // Runtime: O(n / 64)
+    void reset(std::size_t n) {
+        levels.clear();
+        do {
+            n = (n + 63) / 64;
+            levels.emplace_back(n, 0);
+        } while (n > 1);
+    } // reset()
+
+    // Description: Mark bucket i not empty.
+    // Runtime: O(1)
+    void set(std::size_t i) {
+        for (std::vector<std::uint64_t> &level : levels) {
+            std::uint64_t &word = level[i / 64];
+            bool wasZero = word == 0;
+            word |= std::uint64_t{ 1 } << (i % 64);
+            if (!wasZero)
+                return;
+            i /= 64;
+        } // for
+    } // set()
+
+    // Description: Mark bucket i empty.
+    // Runtime: O(1)
+    void clear(std::size_t i) {
+        for (std::vector<std::uint64_t> &level : levels) {
+            std::uint64_t &word = level[i / 64];
+            word &= ~(std::uint64_t{ 1 } << (i % 64));
+            if (word != 0)
+                return;
+            i /= 64;
+        } // for
+    } // clear()
+
+    // Description: The lowest bucket that is not empty; there must be one.
+    // Runtime: O(1)
+    std::size_t first() const {
+        std::size_t i = 0;
+        for (auto level = levels.rbegin(); level != levels.rend(); ++level)
+            i = i * 64 + pqLowestBit((*level)[i]);
+        return i;
+    } // first()
+
+private:
+    std::vector<std::vector<std::uint64_t>> levels;
+}; // BucketBitmap
+
+
+// A bucket queue for integer keys (priorities) from a limited range: one FIFO
+// bucket per key, and a BucketBitmap of the buckets that are not empty.  Push
+// appends to the element's bucket, and top() and pop() use the front of the
+// first bucket, so all three are O(1), and elements with equal keys come out
+// in the order they went in.  The comparator only decides the direction (see
+// BucketSmallestFirst); within a key it is never called.
+//
+// The buckets cover a window of keys that grows, by rebuilding, to take in
+// any key pushed outside it.  In the default Fixed mode each bucket holds one
+// key, so the window is as wide as the range of keys in the queue: ideal for
+// a few hundred priority classes, wasteful for keys spread over millions.
+// So that memory stays in proportion to the elements, Fixed mode uses at most
+// about two buckets per element (and at least 1024); keys spread wider than
+// that share wider buckets, kept sorted as in Calendar mode, until enough
+// elements arrive to narrow them again.
+//
+// Calendar mode is for such keys, like event times: each bucket holds a range
+// of 2^w keys, kept sorted (equal keys still FIFO), and the number of buckets
+// and their width are recomputed as the queue grows and shrinks, so that
+// there are about two elements per bucket across the keys in use.  Keys
+// that are spread evenly then cost O(1) per operation on average.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         typename KEY_FUNCTOR = BucketKey<TYPE>>
+class BucketPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // How keys map to buckets; see above.
+    enum class BucketMode { Fixed, Calendar };
+
+    // Description: Construct an empty heap with optional comparison and key
+    //              functors.
+    // Runtime: O(1)
+    explicit BucketPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), KEY_FUNCTOR keyOf = KEY_FUNCTOR()) :
+        BaseClass{ comp }, key{ keyOf }, mode{ BucketMode::Fixed }, count{ 0 }, base{ 0 }, shift{ 0 } {
+    } // BucketPQ
+
+
+    // Description: Construct a heap out of an iterator range with optional
+    //              comparison and key functors.
+    // Runtime: O(n + k) for n elements over a range of k keys
+    template<typename InputIterator>
+    BucketPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+             KEY_FUNCTOR keyOf = KEY_FUNCTOR()) :
+        BaseClass{ comp }, key{ keyOf }, mode{ BucketMode::Fixed }, count{ 0 }, base{ 0 }, shift{ 0 } {
+        std::vector<TYPE> all{ start, end };
+        rebuild(all, true);
+    } // BucketPQ
+
+
+    // Description: Destructor doesn't need any code, the buckets will be
+    //              destroyed automatically.
+    virtual ~BucketPQ() {
+    } // ~BucketPQ()
+
+
+    // Description: Choose how keys map to buckets; see BucketMode above.
+    // Runtime: O(n log(n)) to move the elements to the new buckets
+    void setMode(BucketMode newMode) {
+        mode = newMode;
+        rebuildAll(false);
+    } // setMode()
+
+
+    // Description: The number of keys each bucket holds: 1 in Fixed mode
+    //              unless the keys are spread too thin for one bucket each.
+    // Runtime: O(1)
+    std::uint64_t bucketWidth() const {
+        return std::uint64_t{ 1 } << shift;
+    } // bucketWidth()
+
+
+    // Description: Assumes that the keys have changed and moves every element
+    //              to its new bucket.  Elements whose keys are still equal
+    //              keep their order.
+    // Runtime: O(n log(n) + k) for n elements over a range of k keys
+    virtual void updatePriorities() {
+        rebuildAll(true);
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(1) amortized; O(bucket size) in Calendar mode
+    virtual void push(const TYPE &val) {
+        insert(val);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        insert(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed from 'args'.  Its
+    //              key decides which bucket it goes in, so it is built first
+    //              and then moved there.
+    // Runtime: O(1) amortized; O(bucket size) in Calendar mode
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        insert(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Remove the most extreme element: the first one pushed of
+    //              those with the most extreme key.
+    // Runtime: O(1), amortized in Calendar mode
+    virtual void pop() {
+        std::size_t first = occupied.first();
+        Bucket &bucket = buckets[first];
+        ++bucket.head;
+        if (bucket.head == bucket.items.size()) {
+            bucket.items.clear();
+            bucket.head = 0;
+            occupied.clear(first);
+        } else if (bucket.head >= 32 && 2 * bucket.head >= bucket.items.size()) {
+            // A bucket that never quite empties drops its popped front now
+            // and then, so it does not grow forever.
+            bucket.items.erase(bucket.items.begin(), bucket.items.begin() + static_cast<std::ptrdiff_t>(bucket.head));
+            bucket.head = 0;
+        } // if
+        --count;
+        if (mode == BucketMode::Calendar && buckets.size() > MIN_BUCKETS && 8 * count < buckets.size())
+            rebuildAll(false);
+    } // pop()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              in the order pop() would, moving each one out before its
+    //              pop.
+    // Runtime: O(k), amortized in Calendar mode
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for (; k != 0 && count != 0; --k) {
+            Bucket &bucket = buckets[occupied.first()];
+            *out++ = std::move(bucket.items[bucket.head]);
+            pop();
+        } // for
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Return the most extreme element: the first one pushed of
+    //              those with the most extreme key.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        const Bucket &bucket = buckets[occupied.first()];
+        return bucket.items[bucket.head];
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return count;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return count == 0;
+    } // empty()
+
+
+private:
+    static constexpr bool SMALLEST_FIRST = BucketSmallestFirst<COMP_FUNCTOR>::value;
+    static constexpr std::size_t MIN_BUCKETS = 64;
+    // Fixed mode may use this many buckets, or two per element if that is
+    // more, before it makes them wider.
+    static constexpr std::size_t MIN_FIXED_BUCKETS = 1024;
+
+    // A FIFO: the elements are items[head, items.size()), and popping from
+    // the front only moves 'head' until the bucket is empty.
+    struct Bucket {
+        std::vector<TYPE> items;
+        std::size_t head = 0;
+    };
+
+    KEY_FUNCTOR key;
+    BucketMode mode;
+    std::size_t count;
+    // Bucket i holds the ranks [base + (i << shift), base + ((i + 1) << shift)).
+    std::vector<Bucket> buckets;
+    BucketBitmap occupied;
+    std::uint64_t base;
+    unsigned shift;
+
+    // Keys as unsigned ranks, the most extreme first, so that the first
+    // bucket that is not empty always holds the next element.
+    std::uint64_t rankOf(const TYPE &val) const {
+        std::uint64_t bits = pqOrderedBits(key(val));
+        return SMALLEST_FIRST ? bits : ~bits;
+    } // rankOf()
+
+    bool inWindow(std::uint64_t rank) const {
+        return rank >= base && ((rank - base) >> shift) < buckets.size();
+    } // inWindow()
+
+    template<typename T>
+    void insert(T &&val) {
+        std::uint64_t rank = rankOf(val);
+        // Wide buckets are redrawn as the queue grows: in Calendar mode to
+        // keep them short, and in Fixed mode to narrow them again.
+        bool grown = mode == BucketMode::Calendar ? count >= 4 * buckets.size()
+                                                  : shift != 0 && count >= buckets.size();
+        if (!inWindow(rank) || grown) {
+            std::vector<TYPE> all = takeAll();
+            all.push_back(std::forward<T>(val));
+            rebuild(all, false);
+            return;
+        } // if
+        place(std::forward<T>(val), rank);
+        ++count;
+    } // insert()
+
+    // Put an element in its bucket, after any with the same rank.  In Fixed
+    // mode, and for keys that arrive in order, that is the back.
+    template<typename T>
+    void place(T &&val, std::uint64_t rank) {
+        std::size_t index = static_cast<std::size_t>((rank - base) >> shift);
+        Bucket &bucket = buckets[index];
+        if (bucket.head == bucket.items.size())
+            occupied.set(index);
+        if (bucket.head == bucket.items.size() || rankOf(bucket.items.back()) <= rank) {
+            bucket.items.push_back(std::forward<T>(val));
+            return;
+        } // if
+        auto position = std::upper_bound(bucket.items.begin() + static_cast<std::ptrdiff_t>(bucket.head),
+            bucket.items.end(), rank, [this](std::uint64_t r, const TYPE &elt) { return r < rankOf(elt); });
+        bucket.items.insert(position, std::forward<T>(val));
+    } // place()
+
+    // Move every element out, bucket by bucket, which is in pop() order.
+    std::vector<TYPE> takeAll() {
+        std::vector<TYPE> all;
+        all.reserve(count + 1);
+        for (Bucket &bucket : buckets) {
+            for (std::size_t i = bucket.head; i < bucket.items.size(); ++i)
+                all.push_back(std::move(bucket.items[i]));
+        } // for
+        return all;
+    } // takeAll()
+
+    void rebuildAll(bool keysChanged) {
+        std::vector<TYPE> all = takeAll();
+        rebuild(all, keysChanged);
+    } // rebuildAll()
+
+    // Lay out new buckets for the ranks in 'all' and put them back.  Unless
+    // 'all' is already in pop() order (apart from its last element, a new
+    // one), it is stably sorted first.  The window gets half its span again as
+    // room on each side, so that keys just outside it do not force another
+    // rebuild right away.
+    void rebuild(std::vector<TYPE> &all, bool unordered) {
+        auto byRank = [this](const TYPE &a, const TYPE &b) { return rankOf(a) < rankOf(b); };
+        if (unordered) {
+            std::stable_sort(all.begin(), all.end(), byRank);
+        } else if (all.size() > 1 && byRank(all.back(), all[all.size() - 2])) {
+            // Only the new element can be out of place.
+            auto position = std::upper_bound(all.begin(), all.end() - 1, all.back(), byRank);
+            std::rotate(position, all.end() - 1, all.end());
+        } // if
+
+        count = all.size();
+        std::uint64_t low = all.empty() ? 0 : rankOf(all.front());
+        std::uint64_t high = all.empty() ? 0 : rankOf(all.back());
+        base = low - std::min(low, (high - low) / 2);
+        std::uint64_t reach = (high - base) + (high - low) / 2;
+        reach = std::max(reach, high - base);
+
+        std::size_t size = MIN_BUCKETS;
+        if (mode == BucketMode::Fixed) {
+            std::size_t limit = std::max(MIN_FIXED_BUCKETS, 2 * count);
+            while (size <= reach && size < limit)
+                size *= 2;
+        } else {
+            while (2 * size < count)
+                size *= 2;
+        } // if
+        shift = 0;
+        while ((reach >> shift) >= size)
+            ++shift;
+        if (buckets.size() > 4 * size) {
+            // Far fewer buckets than before: let the old ones go.
+            std::vector<Bucket>(size).swap(buckets);
+        } else {
+            // Keep the buckets' storage: most of it is needed again right away.
+            for (Bucket &bucket : buckets) {
+                bucket.items.clear();
+                bucket.head = 0;
+            } // for
+            buckets.resize(size);
+        } // if
+        occupied.reset(size);
+        for (TYPE &elt : all) {
+            std::uint64_t rank = rankOf(elt);
+            place(std::move(elt), rank);
+        } // for
+    } // rebuild()
+}; // BucketPQ
+
+
+#endif // BUCKETPQ_H
@@ -0,0 +1,330 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef CHUNKEDSORTEDPQ_H
+#define CHUNKEDSORTEDPQ_H
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "Eecs281PQ.h"
+#include "PQParallel.h"
+
+// A version of SortedPQ whose sorted array is cut into chunks of at most
+// CHUNK elements, like the leaves of a B+-tree.  The chunks are in order and
+// each one is sorted, so the most extreme element is at the back of the last
+// chunk, and walking the chunks front to back visits the elements in sorted
+// order, one contiguous block at a time.
+//
+// A push binary searches the chunks (by their last element) and then the
+// chunk it belongs in, and only shifts elements within that chunk.  A chunk
+// that overflows is split in half, which shifts the much shorter vector of
+// chunks.  That makes push O(CHUNK + n / CHUNK) instead of SortedPQ's O(n),
+// while top() and pop() stay O(1).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, std::size_t CHUNK = 512>
+class ChunkedSortedPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    static_assert(CHUNK >= 2, "A chunk must be able to split in two");
+
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit ChunkedSortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, count{ 0 } {
+    } // ChunkedSortedPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n log n) where n is number of elements in range.
+    template<typename InputIterator>
+    ChunkedSortedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, count{ 0 } {
+        std::vector<TYPE> all{ start, end };
+        rebuild(all);
+    } // ChunkedSortedPQ
+
+
+    // Description: Destructor doesn't need any code, the chunks will be
+    //              destroyed automatically.
+    virtual ~ChunkedSortedPQ() {
+    } // ~ChunkedSortedPQ()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n) + CHUNK + n / CHUNK)
+    virtual void push(const TYPE &val) {
+        insert(val);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        insert(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed from 'args'.  As
+    //              in SortedPQ, it is built first and then moved into place.
+    // Runtime: O(log(n) + CHUNK + n / CHUNK)
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        insert(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: O(1)
+    virtual void pop() {
+        chunks.back().pop_back();
+        if (chunks.back().empty())
+            chunks.pop_back();
+        --count;
+    } // pop()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first: whole chunks off the back, then part
+    //              of the next one.
+    // Runtime: O(k)
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        k = std::min(k, count);
+        count -= k;
+        while (k != 0) {
+            std::vector<TYPE> &chunk = chunks.back();
+            std::size_t taken = std::min(k, chunk.size());
+            auto first = chunk.end() - static_cast<std::ptrdiff_t>(taken);
+            out = std::move(chunk.rbegin(), std::make_reverse_iterator(first), out);
+            chunk.erase(first, chunk.end());
+            if (chunk.empty())
+                chunks.pop_back();
+            k -= taken;
+        } // while
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Walks the chunks front to back, so the elements in sorted order.  It
+    // counts its position as it goes, and the difference of two iterators
+    // is the difference of their positions, so that 'it - begin()' is the
+    // position markDirty() takes.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = TYPE;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const TYPE *;
+        using reference = const TYPE &;
+
+        const_iterator() : chunks{ nullptr }, chunk{ 0 }, index{ 0 }, position{ 0 } {}
+
+        reference operator*() const {
+            return (*chunks)[chunk][index];
+        }
+
+        pointer operator->() const {
+            return &(*chunks)[chunk][index];
+        }
+
+        const_iterator &operator++() {
+            ++position;
+            if (++index == (*chunks)[chunk].size()) {
+                ++chunk;
+                index = 0;
+            } // if
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        difference_type operator-(const const_iterator &other) const {
+            return static_cast<difference_type>(position) - static_cast<difference_type>(other.position);
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return position == other.position;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return position != other.position;
+        }
+
+    private:
+        friend class ChunkedSortedPQ;
+
+        const_iterator(const std::vector<std::vector<TYPE>> *chunks_, std::size_t chunk_, std::size_t position_) :
+            chunks{ chunks_ }, chunk{ chunk_ }, index{ 0 }, position{ position_ } {}
+
+        const std::vector<std::vector<TYPE>> *chunks;
+        std::size_t chunk;
+        std::size_t index;
+        std::size_t position;
+    }; // const_iterator
+
+
+    // Description: The elements in sorted order, most extreme last, as in
+    //              SortedPQ.
+    // Runtime: O(1)
+    const_iterator begin() const {
+        return const_iterator{ &chunks, 0, 0 };
+    } // begin()
+
+    const_iterator end() const {
+        return const_iterator{ &chunks, chunks.size(), count };
+    } // end()
+
+
+    // Description: Record that the element at 'position' has changed priority,
+    //              for the next updatePriorities().  As in SortedPQ, a position
+    //              counts in sorted order (the order of begin() to end()), from
+    //              0 for the least extreme element up to size() - 1 for top().
+    //              Mark every changed element before calling anything else on
+    //              the heap.
+    // Runtime: O(1)
+    void markDirty(std::size_t position) {
+        dirty.push_back(position);
+    } // markDirty()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return chunks.back().back();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return count;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return count == 0;
+    } // empty()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by sorting them and cutting them into
+    //              chunks again.  If markDirty() was called since the last
+    //              rebuild, only the marked elements are taken out and pushed
+    //              again, unless there are so many that a rebuild is cheaper.
+    // Runtime: O(n log n), or O(n / CHUNK + k (CHUNK + n / CHUNK)) for k
+    //          marked elements
+    virtual void updatePriorities() {
+        if (!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), count)) {
+            reinsertDirty();
+            return;
+        } // if
+        dirty.clear();
+        std::vector<TYPE> all;
+        all.reserve(count);
+        for (std::vector<TYPE> &chunk : chunks)
+            std::move(chunk.begin(), chunk.end(), std::back_inserter(all));
+        rebuild(all);
+    } // updatePriorities()
+
+
+private:
+    // Every chunk is sorted and non-empty, and every element of a chunk is no
+    // more extreme than any element of a later chunk.
+    std::vector<std::vector<TYPE>> chunks;
+    std::size_t count;
+    // Positions passed to markDirty() since the last updatePriorities().
+    std::vector<std::size_t> dirty;
+
+    // Take the marked elements out of their chunks in one walk over the
+    // chunks, drop any chunks left empty, then push the elements again.
+    void reinsertDirty() {
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        std::vector<TYPE> moved;
+        auto next = dirty.begin();
+        std::size_t offset = 0;
+        for (std::vector<TYPE> &chunk : chunks) {
+            std::size_t length = chunk.size();
+            if (next == dirty.end() || *next >= offset + length) {
+                offset += length;
+                continue;
+            } // if
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < length; ++i) {
+                if (next != dirty.end() && *next == offset + i) {
+                    moved.push_back(std::move(chunk[i]));
+                    ++next;
+                } else if (kept++ != i) {
+                    chunk[kept - 1] = std::move(chunk[i]);
+                }
+            } // for
+            chunk.erase(chunk.begin() + static_cast<std::ptrdiff_t>(kept), chunk.end());
+            offset += length;
+        } // for
+        dirty.clear();
+        chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+            [](const std::vector<TYPE> &chunk) { return chunk.empty(); }), chunks.end());
+
+        count -= moved.size();
+        for (TYPE &elt : moved)
+            insert(std::move(elt));
+    } // reinsertDirty()
+
+    // Sort 'all' and deal it out into half-full chunks, so that the next pushes
+    // have room before they split anything.
+    void rebuild(std::vector<TYPE> &all) {
+        parallelSort(all.begin(), all.end(), this->compare);
+        chunks.clear();
+        count = all.size();
+        for (std::size_t first = 0; first < all.size(); first += CHUNK / 2) {
+            auto begin = all.begin() + static_cast<std::ptrdiff_t>(first);
+            auto end = all.begin() + static_cast<std::ptrdiff_t>(std::min(first + CHUNK / 2, all.size()));
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK + 1);
+            std::move(begin, end, std::back_inserter(chunks.back()));
+        }
+    } // rebuild()
+
+    // As in SortedPQ, a new element goes before any equal ones: into the first
+    // chunk whose last element is not less than it (or the last chunk).
+    template<typename T>
+    void insert(T &&val) {
+        ++count;
+        if (chunks.empty()) {
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK + 1);
+            chunks.back().push_back(std::forward<T>(val));
+            return;
+        }
+
+        auto chunk = std::lower_bound(chunks.begin(), chunks.end() - 1, val,
+            [this](const std::vector<TYPE> &c, const TYPE &v) { return this->compare(c.back(), v); });
+        auto position = std::lower_bound(chunk->begin(), chunk->end(), val, this->compare);
+        chunk->insert(position, std::forward<T>(val));
+
+        if (chunk->size() > CHUNK) {
+            // Move the upper half into a new chunk right after this one.
+            std::vector<TYPE> upper;
+            upper.reserve(CHUNK + 1);
+            auto middle = chunk->begin() + static_cast<std::ptrdiff_t>(chunk->size() / 2);
+            std::move(middle, chunk->end(), std::back_inserter(upper));
+            chunk->erase(middle, chunk->end());
+            chunks.insert(chunk + 1, std::move(upper));
+        } // if
+    } // insert()
+}; // ChunkedSortedPQ
+
+
+#endif // CHUNKEDSORTEDPQ_H
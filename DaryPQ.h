@@ -0,0 +1,246 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef DARYPQ_H
+#define DARYPQ_H
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include "Eecs281PQ.h"
+
+// A specialized version of the 'heap' ADT implemented as a d-ary heap, where
+// every node has up to D children.  D is a compile-time constant, so the scan
+// for the most extreme child is unrolled.  The children of a node sit next to
+// each other in 'data', so with D * sizeof(TYPE) <= 64 one scan touches at
+// most two cache lines, and the tree is only log_D(n) levels deep.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, std::size_t D = 4>
+class DaryPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    static_assert(D >= 2, "A d-ary heap needs at least two children per node");
+
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit DaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // DaryPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    DaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data{ start, end } {
+            updatePriorities();
+    } // DaryPQ
+
+
+    // Description: Destructor doesn't need any code, the data vector will
+    //              be destroyed automatically.
+    virtual ~DaryPQ() {
+    } // ~DaryPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the heap invariant.  If
+    //              markDirty() was called since the last rebuild, only the
+    //              marked elements are assumed to be out of order, as in
+    //              BinaryPQ.
+    // Runtime: O(n), or O(k D log^2(n)) for k marked elements
+    virtual void updatePriorities() {
+        if(!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), data.size(), 2)) {
+            repairDirty();
+            return;
+        }
+        dirty.clear();
+        if(data.size() < 2) {
+            return;
+        }
+        for(size_t i = parent(data.size() - 1) + 1; i != 0; --i) {
+            fix_down(i - 1);
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n))
+    virtual void push(const TYPE &val) {
+        data.push_back(val);
+        fix_up(data.size() - 1);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+        fix_up(data.size() - 1);
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed in place.
+    // Runtime: O(log(n))
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        fix_up(data.size() - 1);
+    } // emplace()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: O(D log(n) / log(D))
+    virtual void pop() {
+        if(data.size() > 1) {
+            data.front() = std::move(data.back());
+        }
+        data.pop_back();
+        if(!data.empty()) {
+            fix_down(0);
+        }
+    } // pop()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first, moving each one out before its pop.
+    // Runtime: O(k log(n))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for(; k != 0 && !data.empty(); --k) {
+            *out++ = std::move(data.front());
+            pop();
+        }
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Record that the element at 'position' (an offset from
+    //              begin()) has changed priority, for the next
+    //              updatePriorities().  Mark every changed element before
+    //              calling anything else on the heap.
+    // Runtime: O(1)
+    void markDirty(std::size_t position) {
+        dirty.push_back(position);
+    } // markDirty()
+
+
+    // Description: The elements in no particular order, so that markDirty()
+    //              has positions to refer to.
+    // Runtime: O(1)
+    typename std::vector<TYPE>::const_iterator begin() const {
+        return data.begin();
+    } // begin()
+
+    typename std::vector<TYPE>::const_iterator end() const {
+        return data.end();
+    } // end()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return data.front();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return data.empty();
+    } // empty()
+
+
+private:
+    // Unlike BinaryPQ, indexing is 0-based: the children of node k are
+    // D * k + 1 through D * k + D.
+    std::vector<TYPE> data;
+    // Positions passed to markDirty() since the last updatePriorities().
+    std::vector<std::size_t> dirty;
+
+    static size_t parent(size_t k) {
+        return (k - 1) / D;
+    }
+
+    // Fixes the marked elements and their ancestors down in decreasing index
+    // order, like BinaryPQ::repairDirty().  As there, positions past the end,
+    // left by elements popped after they were marked, are skipped.
+    void repairDirty() {
+        std::priority_queue<size_t> pending;
+        for(size_t position : dirty) {
+            if(position < data.size()) {
+                pending.push(position);
+            }
+        }
+        dirty.clear();
+        size_t done = data.size();
+        while(!pending.empty()) {
+            size_t k = pending.top();
+            pending.pop();
+            if(k == done) {
+                continue;
+            }
+            done = k;
+            fix_down(k);
+            if(k > 0) {
+                pending.push(parent(k));
+            }
+        }
+    }
+
+    // Both fixes carry the moving element in a temporary and shift the others
+    // into the hole, instead of swapping at every level.
+    void fix_up(size_t k) {
+        TYPE moving = std::move(data[k]);
+        while(k > 0 && this->compare(data[parent(k)], moving)) {
+            data[k] = std::move(data[parent(k)]);
+            k = parent(k);
+        }
+        data[k] = std::move(moving);
+    }
+
+    void fix_down(size_t k) {
+        TYPE moving = std::move(data[k]);
+        while(true) {
+            size_t first = D * k + 1;
+            if(first >= data.size()) {
+                break;
+            }
+            size_t best = first;
+            if(first + D <= data.size()) {
+                // A full group of children: the trip count is a compile-time
+                // constant, so the compiler unrolls this loop, and the select
+                // compiles to conditional moves instead of branches.
+                for(size_t c = first + 1; c < first + D; ++c) {
+                    best = this->compare(data[best], data[c]) ? c : best;
+                }
+            } else {
+                for(size_t c = first + 1; c < data.size(); ++c) {
+                    if(this->compare(data[best], data[c])) {
+                        best = c;
+                    }
+                }
+            }
+            if(!this->compare(moving, data[best])) {
+                break;
+            }
+            data[k] = std::move(data[best]);
+            k = best;
+        }
+        data[k] = std::move(moving);
+    }
+}; // DaryPQ
+
+
+#endif // DARYPQ_H
@@ -3,12 +3,22 @@
 #ifndef EECS281_PQ_H
 #define EECS281_PQ_H
 
+#include <cstddef>
 #include <functional>
 #include <iterator>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // A simple interface that implements a generic priority queue.
 // Runtime specifications assume constant time comparison and copying.
+//
+// Every call through an Eecs281PQ pointer or reference is virtual.  All the
+// derived PQs are declared 'final', so when code names the concrete type
+// (e.g. a BinaryPQ<int> local, or a template parameter) the compiler calls
+// and inlines their member functions directly.  Use Eecs281PQ only where the
+// implementation really has to be chosen at runtime, like testPQ's menu, and
+// IsStaticPQ (below) to check the interface of a template parameter.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
 class Eecs281PQ {
 public:
@@ -17,6 +27,18 @@ public:
     // Description: Add a new element to the priority queue.
     virtual void push(const TYPE &val) = 0;
 
+    // Description: Add a new element to the priority queue, moving it out of
+    //              'val' instead of copying it.
+    virtual void push(TYPE &&val) = 0;
+
+    // Description: Add a new element to the priority queue, constructed from
+    //              'args'.  The derived PQs hide this with versions that build
+    //              the element in place where they can.
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        push(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the priority queue.
     // Note: We will not run tests on your code that would require it to pop an
@@ -24,6 +46,29 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     virtual void pop() = 0;
 
+    // Description: Remove the k most extreme elements (or all of them, if
+    //              there are fewer) and write them to 'out', most extreme
+    //              first, as k calls to top() and pop() would.  Returns the
+    //              iterator past the last element written.  The derived PQs
+    //              hide this with faster versions; through an Eecs281PQ
+    //              pointer this reaches them by way of popBatch().
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        std::vector<TYPE> batch;
+        popBatch(k, batch);
+        return std::move(batch.begin(), batch.end(), out);
+    } // popK()
+
+    // Description: popK() into the back of 'batch'.  This default just copies
+    //              top() and pops, k times; the derived PQs override it to
+    //              call their own popK().
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        for (; k != 0 && !empty(); --k) {
+            batch.push_back(top());
+            pop();
+        }
+    } // popBatch()
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the priority queue.
     virtual const TYPE &top() const = 0;
@@ -51,7 +96,40 @@ protected:
     // With the default compare function (std::less), this will
     // tell you if Thing1 is lower priority than Thing2.
     COMP_FUNCTOR compare;
+
+    // Description: Used by the markDirty() functions of the derived PQs: true
+    //              if repairing 'dirty' elements, at about log(n)^logs work
+    //              each, would cost more than rebuilding all n elements.
+    static bool preferRebuild(std::size_t dirty, std::size_t n, unsigned logs = 1) {
+        std::size_t log = 1;
+        while ((std::size_t{ 1 } << log) < n)
+            ++log;
+        for (unsigned i = 0; i < logs; ++i)
+            dirty *= log;
+        return dirty > n;
+    } // preferRebuild()
 }; // Eecs281PQ
 
 
+// IsStaticPQ<PQ, TYPE>::value is true if PQ has the Eecs281PQ member
+// functions for elements of type TYPE, whether or not it derives from
+// Eecs281PQ.  Generic code can static_assert it on its template parameter
+// instead of taking an Eecs281PQ reference, and so avoid virtual calls.
+template<typename PQ, typename TYPE, typename = void>
+struct IsStaticPQ : std::false_type {};
+
+template<typename PQ, typename TYPE>
+struct IsStaticPQ<PQ, TYPE, std::void_t<
+    decltype(std::declval<PQ &>().push(std::declval<const TYPE &>())),
+    decltype(std::declval<PQ &>().push(std::declval<TYPE &&>())),
+    decltype(std::declval<PQ &>().pop()),
+    decltype(std::declval<PQ &>().updatePriorities()),
+    std::enable_if_t<std::is_convertible<decltype(std::declval<const PQ &>().top()),
+                                         const TYPE &>::value>,
+    std::enable_if_t<std::is_convertible<decltype(std::declval<const PQ &>().size()),
+                                         std::size_t>::value>,
+    std::enable_if_t<std::is_convertible<decltype(std::declval<const PQ &>().empty()),
+                                         bool>::value>>> : std::true_type {};
+
+
 #endif
@@ -0,0 +1,277 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef FINDEXTREME_H
+#define FINDEXTREME_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// The linear scan used by UnorderedPQ and UnorderedFastPQ to find their most
+// extreme element.  For int32_t, uint32_t, float and double elements compared
+// with std::less or std::greater, the scan is done with AVX2 or SSE4.1,
+// chosen at runtime by what the CPU supports.  Everything else (and any
+// build that is not GCC/Clang on x86) uses the plain scalar loop.
+//
+// The vector kernels return exactly the index the scalar loop would: the
+// first occurrence of the extreme value.  For floating point that includes
+// the scalar loop's handling of NaN (a NaN in the first slot wins, any other
+// NaN is never chosen) and of -0.0 == +0.0.
+//
+// popExtremes() is the batch version the two queues (and BinaryPQ, for large
+// batches) use for popK(): it takes the k most extreme elements out in one
+// selection pass.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FINDEXTREME_SIMD 1
+#include <immintrin.h>
+#endif
+
+
+// Description: Return the index of the most extreme element of data[0, n),
+//              where 'a' is less extreme than 'b' if compare(a, b).  Ties go
+//              to the first such element.  Returns 0 if n is 0.
+// Runtime: O(n)
+template<typename TYPE, typename COMP_FUNCTOR>
+std::size_t findExtremeIndex(const TYPE *data, std::size_t n, const COMP_FUNCTOR &compare);
+
+
+// Description: Move the k most extreme elements of 'data' (all of them, if
+//              it has fewer) to 'out', most extreme first, and remove them
+//              from 'data'.  The rest of 'data' is left in no particular
+//              order.  Equally extreme elements come out in no particular
+//              order either.
+// Runtime: O(n + k log(k))
+template<typename TYPE, typename COMP_FUNCTOR, typename OutputIt>
+OutputIt popExtremes(std::vector<TYPE> &data, std::size_t k, const COMP_FUNCTOR &compare, OutputIt out);
+
+
+// Description: The instruction set findExtremeIndex() uses: 2 for AVX2, 1 for
+//              SSE4.1, 0 for scalar only.  It starts out as the best one the
+//              CPU supports; tests and benchmarks may lower it.
+inline int &findExtremeSimdLevel() {
+#ifdef FINDEXTREME_SIMD
+    static int level = __builtin_cpu_supports("avx2") ? 2 : __builtin_cpu_supports("sse4.1") ? 1 : 0;
+#else
+    static int level = 0;
+#endif
+    return level;
+} // findExtremeSimdLevel()
+
+
+// Scalar version, for every TYPE and comparator.
+template<typename TYPE, typename COMP_FUNCTOR>
+std::size_t findExtremeScalar(const TYPE *data, std::size_t n, const COMP_FUNCTOR &compare) {
+    std::size_t index = 0;
+
+    for (std::size_t i = 1; i < n; ++i)
+        if (compare(data[index], data[i]))
+            index = i;
+
+    return index;
+} // findExtremeScalar()
+
+
+// +1 if COMP_FUNCTOR makes the largest element most extreme, -1 if it makes the
+// smallest most extreme, 0 if the vector kernels cannot be used.
+template<typename TYPE, typename COMP_FUNCTOR>
+struct SimdExtremeDirection : std::integral_constant<int, 0> {};
+
+template<typename TYPE>
+struct SimdExtremeDirection<TYPE, std::less<TYPE>> : std::integral_constant<int, 1> {};
+template<typename TYPE>
+struct SimdExtremeDirection<TYPE, std::less<>> : std::integral_constant<int, 1> {};
+template<typename TYPE>
+struct SimdExtremeDirection<TYPE, std::greater<TYPE>> : std::integral_constant<int, -1> {};
+template<typename TYPE>
+struct SimdExtremeDirection<TYPE, std::greater<>> : std::integral_constant<int, -1> {};
+
+template<typename TYPE>
+struct IsSimdExtremeType : std::integral_constant<bool,
+    std::is_same<TYPE, std::int32_t>::value || std::is_same<TYPE, std::uint32_t>::value
+    || std::is_same<TYPE, float>::value || std::is_same<TYPE, double>::value> {};
+
+
+#ifdef FINDEXTREME_SIMD
+
+// One struct per instruction set and element type, wrapping the intrinsics
+// the kernels need.  Every function carries the target attribute, so this
+// header compiles without -mavx2 and the code only runs if the CPU has it.
+#define FINDEXTREME_AVX2 __attribute__((target("avx2"), always_inline))
+#define FINDEXTREME_SSE4 __attribute__((target("sse4.1"), always_inline))
+
+template<typename TYPE> struct Avx2Ops;
+template<typename TYPE> struct Sse4Ops;
+
+template<> struct Avx2Ops<std::int32_t> {
+    using Vec = __m256i;
+    static constexpr std::size_t WIDTH = 8;
+    static inline FINDEXTREME_AVX2 Vec load(const std::int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static inline FINDEXTREME_AVX2 Vec splat(std::int32_t x) { return _mm256_set1_epi32(x); }
+    static inline FINDEXTREME_AVX2 Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    static inline FINDEXTREME_AVX2 Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    static inline FINDEXTREME_AVX2 void store(std::int32_t *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static inline FINDEXTREME_AVX2 int equal(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+};
+template<> struct Avx2Ops<std::uint32_t> {
+    using Vec = __m256i;
+    static constexpr std::size_t WIDTH = 8;
+    static inline FINDEXTREME_AVX2 Vec load(const std::uint32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static inline FINDEXTREME_AVX2 Vec splat(std::uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static inline FINDEXTREME_AVX2 Vec max(Vec a, Vec b) { return _mm256_max_epu32(a, b); }
+    static inline FINDEXTREME_AVX2 Vec min(Vec a, Vec b) { return _mm256_min_epu32(a, b); }
+    static inline FINDEXTREME_AVX2 void store(std::uint32_t *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static inline FINDEXTREME_AVX2 int equal(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+};
+// For max/min the NaN-free accumulator goes second: when either operand is
+// NaN the instructions return the second one, so NaNs are skipped.
+template<> struct Avx2Ops<float> {
+    using Vec = __m256;
+    static constexpr std::size_t WIDTH = 8;
+    static inline FINDEXTREME_AVX2 Vec load(const float *p) { return _mm256_loadu_ps(p); }
+    static inline FINDEXTREME_AVX2 Vec splat(float x) { return _mm256_set1_ps(x); }
+    static inline FINDEXTREME_AVX2 Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    static inline FINDEXTREME_AVX2 Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    static inline FINDEXTREME_AVX2 void store(float *p, Vec v) { _mm256_storeu_ps(p, v); }
+    static inline FINDEXTREME_AVX2 int equal(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+};
+template<> struct Avx2Ops<double> {
+    using Vec = __m256d;
+    static constexpr std::size_t WIDTH = 4;
+    static inline FINDEXTREME_AVX2 Vec load(const double *p) { return _mm256_loadu_pd(p); }
+    static inline FINDEXTREME_AVX2 Vec splat(double x) { return _mm256_set1_pd(x); }
+    static inline FINDEXTREME_AVX2 Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    static inline FINDEXTREME_AVX2 Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    static inline FINDEXTREME_AVX2 void store(double *p, Vec v) { _mm256_storeu_pd(p, v); }
+    static inline FINDEXTREME_AVX2 int equal(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+};
+
+template<> struct Sse4Ops<std::int32_t> {
+    using Vec = __m128i;
+    static constexpr std::size_t WIDTH = 4;
+    static inline FINDEXTREME_SSE4 Vec load(const std::int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    static inline FINDEXTREME_SSE4 Vec splat(std::int32_t x) { return _mm_set1_epi32(x); }
+    static inline FINDEXTREME_SSE4 Vec max(Vec a, Vec b) { return _mm_max_epi32(a, b); }
+    static inline FINDEXTREME_SSE4 Vec min(Vec a, Vec b) { return _mm_min_epi32(a, b); }
+    static inline FINDEXTREME_SSE4 void store(std::int32_t *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+    static inline FINDEXTREME_SSE4 int equal(Vec a, Vec b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+};
+template<> struct Sse4Ops<std::uint32_t> {
+    using Vec = __m128i;
+    static constexpr std::size_t WIDTH = 4;
+    static inline FINDEXTREME_SSE4 Vec load(const std::uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    static inline FINDEXTREME_SSE4 Vec splat(std::uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+    static inline FINDEXTREME_SSE4 Vec max(Vec a, Vec b) { return _mm_max_epu32(a, b); }
+    static inline FINDEXTREME_SSE4 Vec min(Vec a, Vec b) { return _mm_min_epu32(a, b); }
+    static inline FINDEXTREME_SSE4 void store(std::uint32_t *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+    static inline FINDEXTREME_SSE4 int equal(Vec a, Vec b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+};
+template<> struct Sse4Ops<float> {
+    using Vec = __m128;
+    static constexpr std::size_t WIDTH = 4;
+    static inline FINDEXTREME_SSE4 Vec load(const float *p) { return _mm_loadu_ps(p); }
+    static inline FINDEXTREME_SSE4 Vec splat(float x) { return _mm_set1_ps(x); }
+    static inline FINDEXTREME_SSE4 Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+    static inline FINDEXTREME_SSE4 Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    static inline FINDEXTREME_SSE4 void store(float *p, Vec v) { _mm_storeu_ps(p, v); }
+    static inline FINDEXTREME_SSE4 int equal(Vec a, Vec b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+};
+template<> struct Sse4Ops<double> {
+    using Vec = __m128d;
+    static constexpr std::size_t WIDTH = 2;
+    static inline FINDEXTREME_SSE4 Vec load(const double *p) { return _mm_loadu_pd(p); }
+    static inline FINDEXTREME_SSE4 Vec splat(double x) { return _mm_set1_pd(x); }
+    static inline FINDEXTREME_SSE4 Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+    static inline FINDEXTREME_SSE4 Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+    static inline FINDEXTREME_SSE4 void store(double *p, Vec v) { _mm_storeu_pd(p, v); }
+    static inline FINDEXTREME_SSE4 int equal(Vec a, Vec b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+};
+
+// The kernel: one pass for the extreme value, then one pass for the first
+// index holding it.  Written once and stamped out per instruction set,
+// because each copy has to be compiled for its own target.
+#define FINDEXTREME_KERNEL(NAME, OPS, TARGET)                                      \
+template<typename TYPE, bool LARGEST>                                              \
+TARGET std::size_t NAME(const TYPE *data, std::size_t n) {                          \
+    using Ops = OPS<TYPE>;                                                          \
+    /* The scalar loop never moves away from a NaN in slot 0. */                    \
+    if (data[0] != data[0])                                                         \
+        return 0;                                                                   \
+    typename Ops::Vec best = Ops::splat(data[0]);                                   \
+    std::size_t i = 0;                                                              \
+    for (; i + Ops::WIDTH <= n; i += Ops::WIDTH)                                    \
+        best = LARGEST ? Ops::max(Ops::load(data + i), best)                        \
+                       : Ops::min(Ops::load(data + i), best);                       \
+    TYPE lanes[Ops::WIDTH];                                                         \
+    Ops::store(lanes, best);                                                        \
+    TYPE value = lanes[0];                                                          \
+    for (std::size_t lane = 1; lane < Ops::WIDTH; ++lane)                           \
+        if (LARGEST ? value < lanes[lane] : lanes[lane] < value)                    \
+            value = lanes[lane];                                                    \
+    for (; i < n; ++i)                                                              \
+        if (LARGEST ? value < data[i] : data[i] < value)                            \
+            value = data[i];                                                        \
+                                                                                    \
+    typename Ops::Vec target = Ops::splat(value);                                   \
+    for (i = 0; i + Ops::WIDTH <= n; i += Ops::WIDTH) {                             \
+        int mask = Ops::equal(Ops::load(data + i), target);                         \
+        if (mask != 0)                                                              \
+            return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask))); \
+    }                                                                               \
+    for (; i < n; ++i)                                                              \
+        if (data[i] == value)                                                       \
+            return i;                                                               \
+    return 0;                                                                       \
+}
+
+FINDEXTREME_KERNEL(findExtremeAvx2, Avx2Ops, __attribute__((target("avx2"))))
+FINDEXTREME_KERNEL(findExtremeSse4, Sse4Ops, __attribute__((target("sse4.1"))))
+
+#undef FINDEXTREME_KERNEL
+#undef FINDEXTREME_AVX2
+#undef FINDEXTREME_SSE4
+
+#endif // FINDEXTREME_SIMD
+
+
+template<typename TYPE, typename COMP_FUNCTOR>
+std::size_t findExtremeIndex(const TYPE *data, std::size_t n, const COMP_FUNCTOR &compare) {
+#ifdef FINDEXTREME_SIMD
+    constexpr int direction = SimdExtremeDirection<TYPE, COMP_FUNCTOR>::value;
+    if constexpr (IsSimdExtremeType<TYPE>::value && direction != 0) {
+        // Below a few vectors' worth the scalar loop is just as fast.
+        if (n >= 32) {
+            int level = findExtremeSimdLevel();
+            if (level >= 2)
+                return findExtremeAvx2<TYPE, (direction > 0)>(data, n);
+            if (level == 1)
+                return findExtremeSse4<TYPE, (direction > 0)>(data, n);
+        }
+    }
+#endif
+    return findExtremeScalar(data, n, compare);
+} // findExtremeIndex()
+
+
+
+template<typename TYPE, typename COMP_FUNCTOR, typename OutputIt>
+OutputIt popExtremes(std::vector<TYPE> &data, std::size_t k, const COMP_FUNCTOR &compare, OutputIt out) {
+    k = std::min(k, data.size());
+    if (k == 0)
+        return out;
+    // Partition the k most extreme elements to the back, sort just those, and
+    // take them off the back, last (most extreme) first.
+    auto first = data.end() - static_cast<std::ptrdiff_t>(k);
+    std::nth_element(data.begin(), first, data.end(), compare);
+    std::sort(first, data.end(), compare);
+    for (auto it = data.end(); it != first;)
+        *out++ = std::move(*--it);
+    data.erase(first, data.end());
+    return out;
+} // popExtremes()
+
+#endif // FINDEXTREME_H
@@ -0,0 +1,342 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef INDEXEDBINARYPQ_H
+#define INDEXEDBINARYPQ_H
+
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "Eecs281PQ.h"
+
+// A binary heap that can change or remove any element, like PairingPQ's
+// addNode()/updateElt(), while the elements stay in one contiguous vector.
+//
+// addElt() returns a Handle, a small integer that names the element for as
+// long as it is in the heap, no matter where sifting moves it.  Two vectors
+// map heap positions to handles and handles back to positions, and every
+// move in a sift updates both, so updateKey() and erase() can find their
+// element in O(1) and fix the heap in O(log(n)).  Once an element is popped
+// or erased its handle may be handed out again by a later addElt().
+//
+// Unlike BinaryPQ, indexing is 0-based: the children of node k are 2k + 1
+// and 2k + 2.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class IndexedBinaryPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    using Handle = std::size_t;
+
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit IndexedBinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // IndexedBinaryPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.  The elements get handles 0 to n - 1 in
+    //              the order of the range.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    IndexedBinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data{ start, end } {
+            for(Handle handle = 0; handle < data.size(); ++handle) {
+                handles.push_back(handle);
+                positions.push_back(handle);
+            }
+            updatePriorities();
+    } // IndexedBinaryPQ
+
+
+    // Description: Destructor doesn't need any code, the vectors will be
+    //              destroyed automatically.
+    virtual ~IndexedBinaryPQ() {
+    } // ~IndexedBinaryPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the heap invariant.  Handles
+    //              keep naming the same elements.  If markDirty() was called
+    //              since the last rebuild, only the marked elements are
+    //              assumed to be out of order, as in BinaryPQ.
+    // Runtime: O(n), or O(k log^2(n)) for k marked elements
+    virtual void updatePriorities() {
+        if(!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), data.size(), 2)) {
+            repairDirty();
+            return;
+        }
+        dirty.clear();
+        for(size_t i = data.size() / 2; i != 0; --i) {
+            fix_down(i - 1);
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n))
+    virtual void push(const TYPE &val) {
+        addElt(val);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        addElt(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed in place.
+    //              Returns its Handle just like addElt().
+    // Runtime: O(log(n))
+    template<typename... Args>
+    Handle emplace(Args&&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        return attach();
+    } // emplace()
+
+
+    // Description: Add a new element to the heap and return the Handle that
+    //              names it until it is popped or erased.
+    // Runtime: O(log(n))
+    Handle addElt(const TYPE &val) {
+        data.push_back(val);
+        return attach();
+    } // addElt()
+
+    Handle addElt(TYPE &&val) {
+        data.push_back(std::move(val));
+        return attach();
+    } // addElt()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: O(log(n))
+    virtual void pop() {
+        erase(handles.front());
+    } // pop()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first, moving each one out before its pop.
+    //              Their handles are released as with pop().
+    // Runtime: O(k log(n))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for(; k != 0 && !data.empty(); --k) {
+            *out++ = std::move(data.front());
+            pop();
+        }
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return data.front();
+    } // top()
+
+
+    // Description: Return the Handle of the most extreme element.
+    // Runtime: O(1)
+    Handle topHandle() const {
+        return handles.front();
+    } // topHandle()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return data.empty();
+    } // empty()
+
+
+    // Description: Return true if 'handle' names an element in the heap.
+    //              Handles are reused, so after an element leaves this may
+    //              be true again for a newer element.
+    // Runtime: O(1)
+    bool contains(Handle handle) const {
+        return handle < positions.size() && positions[handle] != NOT_IN_HEAP;
+    } // contains()
+
+
+    // Description: Return the element named by 'handle'.
+    // Runtime: O(1)
+    const TYPE &getElt(Handle handle) const {
+        return data[positions[handle]];
+    } // getElt()
+
+
+    // Description: Replace the element named by 'handle' with 'new_value',
+    //              which may be more or less extreme than the old one.  The
+    //              handle keeps naming it.
+    // Runtime: O(log(n))
+    void updateKey(Handle handle, const TYPE &new_value) {
+        data[positions[handle]] = new_value;
+        fix(positions[handle]);
+    } // updateKey()
+
+    void updateKey(Handle handle, TYPE &&new_value) {
+        data[positions[handle]] = std::move(new_value);
+        fix(positions[handle]);
+    } // updateKey()
+
+
+    // Description: Record that the element named by 'handle' has changed
+    //              priority, for the next updatePriorities().  Mark every
+    //              changed element before calling anything else on the heap.
+    // Runtime: O(1)
+    void markDirty(Handle handle) {
+        dirty.push_back(handle);
+    } // markDirty()
+
+
+    // Description: Remove the element named by 'handle' from the heap; the last
+    //              element takes its place and is fixed up or down.
+    // Runtime: O(log(n))
+    void erase(Handle handle) {
+        size_t k = positions[handle];
+        positions[handle] = NOT_IN_HEAP;
+        freeHandles.push_back(handle);
+        size_t last = data.size() - 1;
+        if(k != last) {
+            data[k] = std::move(data.back());
+            handles[k] = handles.back();
+            positions[handles[k]] = k;
+        }
+        data.pop_back();
+        handles.pop_back();
+        if(k != last) {
+            fix(k);
+        }
+    } // erase()
+
+
+private:
+    static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+    // data[k] is named by handles[k], and positions[handles[k]] == k.
+    // positions[h] is NOT_IN_HEAP for a handle that is on freeHandles.
+    std::vector<TYPE> data;
+    std::vector<Handle> handles;
+    std::vector<size_t> positions;
+    std::vector<Handle> freeHandles;
+    // Handles passed to markDirty() since the last updatePriorities().
+    std::vector<Handle> dirty;
+
+    // Fixes the marked elements and their ancestors down in decreasing
+    // position order, like BinaryPQ::repairDirty().  Handles erased or
+    // popped after they were marked are NOT_IN_HEAP, and skipped.
+    void repairDirty() {
+        std::priority_queue<size_t> pending;
+        for(Handle handle : dirty) {
+            if(positions[handle] < data.size()) {
+                pending.push(positions[handle]);
+            }
+        }
+        dirty.clear();
+        size_t done = data.size();
+        while(!pending.empty()) {
+            size_t k = pending.top();
+            pending.pop();
+            if(k == done) {
+                continue;
+            }
+            done = k;
+            fix_down(k);
+            if(k > 0) {
+                pending.push(parent(k));
+            }
+        }
+    }
+
+    static size_t parent(size_t k) {
+        return (k - 1) / 2;
+    }
+
+    // Give the element just added at the back of 'data' a handle, and fix it
+    // up.
+    Handle attach() {
+        Handle handle;
+        if(freeHandles.empty()) {
+            handle = positions.size();
+            positions.push_back(data.size() - 1);
+        } else {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            positions[handle] = data.size() - 1;
+        }
+        handles.push_back(handle);
+        fix_up(data.size() - 1);
+        return handle;
+    }
+
+    // Move the element at 'from', with its handle, into the hole at 'to'.
+    void shift(size_t from, size_t to) {
+        data[to] = std::move(data[from]);
+        handles[to] = handles[from];
+        positions[handles[to]] = to;
+    }
+
+    // Restore the heap around an element that changed in either direction.
+    void fix(size_t k) {
+        if(k > 0 && this->compare(data[parent(k)], data[k])) {
+            fix_up(k);
+        } else {
+            fix_down(k);
+        }
+    }
+
+    // Both fixes carry the moving element and its handle in temporaries and
+    // shift the others into the hole, as in BinaryPQ.
+    void fix_up(size_t k) {
+        TYPE moving = std::move(data[k]);
+        Handle handle = handles[k];
+        while(k > 0 && this->compare(data[parent(k)], moving)) {
+            shift(parent(k), k);
+            k = parent(k);
+        }
+        data[k] = std::move(moving);
+        handles[k] = handle;
+        positions[handle] = k;
+    }
+
+    void fix_down(size_t k) {
+        if(2 * k + 1 >= data.size()) {
+            return;
+        }
+        TYPE moving = std::move(data[k]);
+        Handle handle = handles[k];
+        while(2 * k + 1 < data.size()) {
+            size_t j = 2 * k + 1;
+            if(j + 1 < data.size() && this->compare(data[j], data[j + 1])) {
+                ++j;
+            }
+            if(!this->compare(moving, data[j])) {
+                break;
+            }
+            shift(j, k);
+            k = j;
+        }
+        data[k] = std::move(moving);
+        handles[k] = handle;
+        positions[handle] = k;
+    }
+}; // IndexedBinaryPQ
+
+
+#endif // INDEXEDBINARYPQ_H
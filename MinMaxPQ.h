@@ -0,0 +1,378 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef MINMAXPQ_H
+#define MINMAXPQ_H
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <utility>
+#include "Eecs281PQ.h"
+
+// A double-ended priority queue implemented as a min-max heap: a binary heap
+// in one vector, laid out like BinaryPQ's, whose levels alternate.  Nodes on
+// even levels (the root is level 0) are the most extreme of their subtrees,
+// and nodes on odd levels the least extreme.  So top() is the root and
+// bottom() is one of its two children, both O(1), and popMax() and popMin()
+// are O(log(n)).
+//
+// With setCapacity(K) it keeps only the K most extreme elements it has been
+// given: once it is full, pushBounded() (and push()) replace the least
+// extreme element, or drop the new one if it is no better.  That streams the
+// best K of any number of elements in O(K) memory and O(log(K)) per element.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class MinMaxPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // The capacity of a heap that keeps every element.
+    static constexpr std::size_t UNBOUNDED = std::numeric_limits<std::size_t>::max();
+
+    // Description: Construct an empty, unbounded heap with an optional
+    //              comparison functor.
+    // Runtime: O(1)
+    explicit MinMaxPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, limit{ UNBOUNDED } {
+    } // MinMaxPQ
+
+
+    // Description: Construct an unbounded heap out of an iterator range with
+    //              an optional comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    MinMaxPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data{ start, end }, limit{ UNBOUNDED } {
+            updatePriorities();
+    } // MinMaxPQ
+
+
+    // Description: Destructor doesn't need any code, the data vector will
+    //              be destroyed automatically.
+    virtual ~MinMaxPQ() {
+    } // ~MinMaxPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the min-max invariant, with
+    //              Floyd's bottom-up method.  If markDirty() was called since
+    //              the last rebuild, only the marked elements are assumed to be
+    //              out of order, as in BinaryPQ.
+    // Runtime: O(n), or O(k log^2(n)) for k marked elements
+    virtual void updatePriorities() {
+        if(!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), data.size(), 2)) {
+            repairDirty();
+            return;
+        }
+        dirty.clear();
+        for(size_t i = data.size() / 2; i != 0; --i) {
+            trickleDown(i - 1);
+        }
+    } // updatePriorities()
+
+
+    // Description: Keep at most 'capacity' elements from now on, dropping the
+    //              least extreme ones if there are more.  The default,
+    //              UNBOUNDED, keeps everything.
+    // Runtime: O((n - capacity) log(n))
+    void setCapacity(std::size_t capacity) {
+        limit = capacity;
+        while(data.size() > limit) {
+            popMin();
+        }
+    } // setCapacity()
+
+
+    // Description: The most elements the heap keeps; see setCapacity().
+    // Runtime: O(1)
+    std::size_t capacity() const {
+        return limit;
+    } // capacity()
+
+
+    // Description: Add a new element to the heap.  If it is full, this is
+    //              pushBounded(), and the least extreme element is dropped.
+    // Runtime: O(log(n))
+    virtual void push(const TYPE &val) {
+        insert(val);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        insert(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed from 'args'.  It
+    //              has to be compared before it is kept, so it is built first
+    //              and then moved into place, as in SortedPQ.
+    // Runtime: O(log(n))
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        insert(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Add a new element to the heap.  If it is already at
+    //              capacity, the new element replaces the least extreme one if
+    //              it is more extreme, and is dropped otherwise.  Returns true
+    //              if the new element was kept.
+    // Runtime: O(log(n))
+    bool pushBounded(const TYPE &val) {
+        return insert(val);
+    } // pushBounded()
+
+    bool pushBounded(TYPE &&val) {
+        return insert(std::move(val));
+    } // pushBounded()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: O(log(n))
+    virtual void pop() {
+        popMax();
+    } // pop()
+
+
+    // Description: Remove the most extreme element, the same as pop().
+    // Runtime: O(log(n))
+    void popMax() {
+        removeAt(0);
+    } // popMax()
+
+
+    // Description: Remove the least extreme element.
+    // Runtime: O(log(n))
+    void popMin() {
+        removeAt(minIndex());
+    } // popMin()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first, moving each one out before its pop.
+    // Runtime: O(k log(n))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for(; k != 0 && !data.empty(); --k) {
+            *out++ = std::move(data.front());
+            popMax();
+        }
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Record that the element at 'position' (an offset from
+    //              begin()) has changed priority, for the next
+    //              updatePriorities().  Mark every changed element before
+    //              calling anything else on the heap.
+    // Runtime: O(1)
+    void markDirty(std::size_t position) {
+        dirty.push_back(position);
+    } // markDirty()
+
+
+    // Description: The elements in no particular order, so that markDirty()
+    //              has positions to refer to.
+    // Runtime: O(1)
+    typename std::vector<TYPE>::const_iterator begin() const {
+        return data.begin();
+    } // begin()
+
+    typename std::vector<TYPE>::const_iterator end() const {
+        return data.end();
+    } // end()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return data.front();
+    } // top()
+
+
+    // Description: Return the least extreme element of the heap.
+    // Runtime: O(1)
+    const TYPE &bottom() const {
+        return data[minIndex()];
+    } // bottom()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return data.empty();
+    } // empty()
+
+
+private:
+    std::vector<TYPE> data;
+    std::size_t limit;
+    // Positions passed to markDirty() since the last updatePriorities().
+    std::vector<std::size_t> dirty;
+
+    // Indexing is 0-based here, as in DaryPQ: the children of node i are
+    // 2i + 1 and 2i + 2.
+    static size_t parent(size_t i) {
+        return (i - 1) / 2;
+    }
+
+    // True if node i is on an even ("max") level.
+    static bool isMaxLevel(size_t i) {
+        size_t level = 0;
+        for(size_t j = i + 1; j > 1; j /= 2) {
+            ++level;
+        }
+        return level % 2 == 0;
+    }
+
+    // True if 'b' belongs above 'a' on a max level (b is more extreme) or on
+    // a min level (b is less extreme).  Writing every step in terms of this
+    // lets one loop handle both kinds of level.
+    bool above(const TYPE &a, const TYPE &b, bool maxLevel) const {
+        return maxLevel ? this->compare(a, b) : this->compare(b, a);
+    }
+
+    // The least extreme element is one of the root's children, or the root
+    // itself if it has none.
+    size_t minIndex() const {
+        if(data.size() < 3) {
+            return data.size() - 1;
+        }
+        return this->compare(data[2], data[1]) ? 2 : 1;
+    }
+
+    // Add 'val' if there is room, or in place of the least extreme element
+    // if it is more extreme than that.
+    template<typename T>
+    bool insert(T &&val) {
+        if(data.size() < limit) {
+            data.push_back(std::forward<T>(val));
+            bubbleUp(data.size() - 1);
+            return true;
+        }
+        if(data.empty() || !this->compare(data[minIndex()], val)) {
+            return false;
+        }
+        // The new element may even belong at the root, above its new parent;
+        // then the old root comes down to its slot and is trickled down.
+        size_t i = minIndex();
+        data[i] = std::forward<T>(val);
+        if(i != 0 && this->compare(data[0], data[i])) {
+            std::swap(data[0], data[i]);
+        }
+        trickleDown(i);
+        return true;
+    }
+
+    // Replace node i, the root or one of its children, with the last element
+    // and trickle that down.  The root is the most extreme element of all, so
+    // the last element never has to go up past it.
+    void removeAt(size_t i) {
+        if(i != data.size() - 1) {
+            data[i] = std::move(data.back());
+        }
+        data.pop_back();
+        if(i < data.size()) {
+            trickleDown(i);
+        }
+    }
+
+    // A new element at i first decides which kind of level it belongs to by
+    // comparing with its parent, then climbs that kind of level only, by
+    // grandparents.  It carries the moving element in a temporary, as in
+    // BinaryPQ, so each level costs one move.
+    void bubbleUp(size_t i) {
+        if(i == 0) {
+            return;
+        }
+        // On a max level, i must not be less extreme than its parent (a min
+        // level), and on a min level not more extreme.
+        bool maxLevel = isMaxLevel(i);
+        if(above(data[i], data[parent(i)], maxLevel)) {
+            std::swap(data[i], data[parent(i)]);
+            i = parent(i);
+            maxLevel = !maxLevel;
+        }
+        TYPE moving = std::move(data[i]);
+        while(i > 2 && above(data[parent(parent(i))], moving, maxLevel)) {
+            data[i] = std::move(data[parent(parent(i))]);
+            i = parent(parent(i));
+        }
+        data[i] = std::move(moving);
+    }
+
+    // Move the element at i down to where its subtree's min-max order holds,
+    // given that both child subtrees are min-max heaps.  Each step looks at
+    // all (up to six) children and grandchildren; after a move to a
+    // grandchild the element may be out of order with its new parent, which
+    // is on the other kind of level, so the two are swapped if needed.
+    void trickleDown(size_t i) {
+        bool maxLevel = isMaxLevel(i);
+        while(2 * i + 1 < data.size()) {
+            size_t first = 2 * i + 1;
+            size_t grandchildren = 2 * first + 1;
+            size_t m = first;
+            if(first + 1 < data.size() && above(data[m], data[first + 1], maxLevel)) {
+                m = first + 1;
+            }
+            for(size_t g = grandchildren; g < grandchildren + 4 && g < data.size(); ++g) {
+                if(above(data[m], data[g], maxLevel)) {
+                    m = g;
+                }
+            }
+            if(!above(data[i], data[m], maxLevel)) {
+                return;
+            }
+            std::swap(data[i], data[m]);
+            if(m < grandchildren) {
+                return;
+            }
+            if(above(data[m], data[parent(m)], maxLevel)) {
+                std::swap(data[m], data[parent(m)]);
+            }
+            i = m;
+        }
+    }
+
+    // Trickle down the marked elements and their ancestors in decreasing
+    // position order, as in BinaryPQ::repairDirty(): every subtree that holds
+    // no marked element is still a min-max heap.  Positions past the end,
+    // left by elements popped after they were marked, are skipped.
+    void repairDirty() {
+        std::priority_queue<size_t> pending;
+        for(size_t position : dirty) {
+            if(position < data.size()) {
+                pending.push(position);
+            }
+        }
+        dirty.clear();
+        size_t done = data.size();
+        while(!pending.empty()) {
+            size_t k = pending.top();
+            pending.pop();
+            if(k == done) {
+                continue;
+            }
+            done = k;
+            trickleDown(k);
+            if(k > 0) {
+                pending.push(parent(k));
+            }
+        }
+    }
+}; // MinMaxPQ
+
+
+#endif // MINMAXPQ_H
@@ -0,0 +1,187 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// A slab allocator for the fixed-size nodes of the node-based priority queues.
+// Nodes are carved out of large slabs and recycled through an intrusive free
+// list, so a node never moves while it is alive and handing out Node* is safe.
+// Slabs are only given back to the system when the pool itself is destroyed.
+//
+// The pool does not know which of its slots are live.  If NODE has a
+// non-trivial destructor, the owner must destroy() every node it created
+// before the pool goes away; otherwise it may simply let the slabs go.
+//
+// Compiling with -DNODEPOOL_USE_HEAP turns create()/destroy() into plain
+// new/delete, which is how the benchmarks compare against the unpooled code.
+template<typename NODE>
+class NodePool {
+public:
+    // True when destroying the pool frees every node it handed out.
+#ifdef NODEPOOL_USE_HEAP
+    static constexpr bool releasesInBulk = false;
+#else
+    static constexpr bool releasesInBulk = true;
+#endif
+
+    NodePool() :
+        slabs{ nullptr }, lastSlab{ nullptr }, freeHead{ nullptr }, freeTail{ nullptr },
+        nextSlabSize{ MIN_SLAB_SIZE } {
+    } // NodePool()
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    NodePool(NodePool &&other) noexcept : NodePool() {
+        swap(other);
+    } // NodePool()
+
+    // The old slabs end up in 'other', along with whatever nodes live in them.
+    NodePool &operator=(NodePool &&other) noexcept {
+        swap(other);
+        return *this;
+    } // operator=()
+
+    ~NodePool() {
+        while (slabs != nullptr) {
+            Slot *next = slabs->next;
+            delete[] slabs;
+            slabs = next;
+        }
+    } // ~NodePool()
+
+
+    // Description: Construct a node in a free slot, allocating a new slab if
+    //              there are none.
+    // Runtime: Amortized O(1)
+    template<typename... Args>
+    NODE *create(Args&&... args) {
+#ifdef NODEPOOL_USE_HEAP
+        return new NODE(std::forward<Args>(args)...);
+#else
+        if (freeHead == nullptr) {
+            reserve(nextSlabSize);
+            if (nextSlabSize < MAX_SLAB_SIZE)
+                nextSlabSize *= 2;
+        }
+
+        Slot *slot = freeHead;
+        freeHead = slot->next;
+        if (freeHead == nullptr)
+            freeTail = nullptr;
+
+        try {
+            return ::new (static_cast<void *>(slot->storage)) NODE(std::forward<Args>(args)...);
+        } catch (...) {
+            release(slot);
+            throw;
+        }
+#endif
+    } // create()
+
+
+    // Description: Destroy a node made by create() and recycle its slot.
+    // Runtime: O(1)
+    void destroy(NODE *node) {
+#ifdef NODEPOOL_USE_HEAP
+        delete node;
+#else
+        node->~NODE();
+        release(reinterpret_cast<Slot *>(node));
+#endif
+    } // destroy()
+
+
+    // Description: Allocate a single slab with room for n more nodes, so that a
+    //              known number of nodes can be created without further calls
+    //              to the system allocator.
+    // Runtime: O(n)
+    void reserve(std::size_t n) {
+#ifndef NODEPOOL_USE_HEAP
+        if (n == 0)
+            return;
+
+        // Slot 0 of every slab only links the slabs together.
+        Slot *slab = new Slot[n + 1];
+        slab[0].next = nullptr;
+        if (lastSlab == nullptr)
+            slabs = slab;
+        else
+            lastSlab->next = slab;
+        lastSlab = slab;
+
+        for (std::size_t i = 1; i < n; ++i)
+            slab[i].next = &slab[i + 1];
+        slab[n].next = freeHead;
+        if (freeHead == nullptr)
+            freeTail = &slab[n];
+        freeHead = &slab[1];
+#else
+        (void)n;
+#endif
+    } // reserve()
+
+
+    // Description: Take over every slab (and free slot) owned by 'other'.
+    //              Nodes that live in those slabs now belong to this pool.
+    // Runtime: O(1)
+    void splice(NodePool &other) {
+#ifndef NODEPOOL_USE_HEAP
+        if (other.slabs != nullptr) {
+            if (lastSlab == nullptr)
+                slabs = other.slabs;
+            else
+                lastSlab->next = other.slabs;
+            lastSlab = other.lastSlab;
+        }
+        if (other.freeHead != nullptr) {
+            if (freeTail == nullptr)
+                freeHead = other.freeHead;
+            else
+                freeTail->next = other.freeHead;
+            freeTail = other.freeTail;
+        }
+        other.slabs = other.lastSlab = other.freeHead = other.freeTail = nullptr;
+#else
+        (void)other;
+#endif
+    } // splice()
+
+
+    void swap(NodePool &other) noexcept {
+        std::swap(slabs, other.slabs);
+        std::swap(lastSlab, other.lastSlab);
+        std::swap(freeHead, other.freeHead);
+        std::swap(freeTail, other.freeTail);
+        std::swap(nextSlabSize, other.nextSlabSize);
+    } // swap()
+
+private:
+    // A slot either holds a live node or links to the next free slot.
+    union Slot {
+        Slot *next;
+        alignas(NODE) unsigned char storage[sizeof(NODE)];
+    };
+
+    static constexpr std::size_t MIN_SLAB_SIZE = 64;
+    static constexpr std::size_t MAX_SLAB_SIZE = 64 * 1024;
+
+    Slot *slabs;
+    Slot *lastSlab;
+    Slot *freeHead;
+    Slot *freeTail;
+    std::size_t nextSlabSize;
+
+    void release(Slot *slot) {
+        slot->next = freeHead;
+        if (freeHead == nullptr)
+            freeTail = slot;
+        freeHead = slot;
+    } // release()
+}; // NodePool
+
+#endif // NODEPOOL_H
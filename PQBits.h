@@ -0,0 +1,70 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef PQBITS_H
+#define PQBITS_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Bit tricks shared by the integer-keyed queues.  With GCC and Clang these
+// are single instructions; elsewhere they fall back to loops.
+
+
+// Description: The number of bits needed to hold x: 0 for 0, else one more
+//              than the index of the highest set bit.
+// Runtime: O(1)
+inline unsigned pqBitWidth(std::uint64_t x) {
+#if defined(__GNUC__)
+    return x == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned width = 0;
+    for (; x != 0; x >>= 1)
+        ++width;
+    return width;
+#endif
+} // pqBitWidth()
+
+
+// Description: The index of the lowest set bit of x, which must not be 0.
+// Runtime: O(1)
+inline unsigned pqLowestBit(std::uint64_t x) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned index = 0;
+    for (; (x & 1) == 0; x >>= 1)
+        ++index;
+    return index;
+#endif
+} // pqLowestBit()
+
+
+// Description: Map an integer or floating point key to a uint64_t with the
+//              same order, so that it can be bucketed by its bits.  Signed
+//              integers have their sign bit flipped.  Floats are ordered by
+//              their sign-flipped bit pattern: -0.0 comes just before +0.0,
+//              and NaNs sort past the infinities.
+// Runtime: O(1)
+template<typename KEY>
+std::uint64_t pqOrderedBits(KEY key) {
+    static_assert(std::is_integral<KEY>::value || std::is_same<KEY, float>::value
+                  || std::is_same<KEY, double>::value,
+                  "keys must be integers, float or double");
+    if constexpr (std::is_same<KEY, float>::value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &key, sizeof bits);
+        return (bits >> 31) != 0 ? ~bits : bits | 0x80000000u;
+    } else if constexpr (std::is_same<KEY, double>::value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &key, sizeof bits);
+        return (bits >> 63) != 0 ? ~bits : bits | (std::uint64_t{ 1 } << 63);
+    } else if constexpr (std::is_signed<KEY>::value) {
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(key)) ^ (std::uint64_t{ 1 } << 63);
+    } else {
+        return key;
+    }
+} // pqOrderedBits()
+
+
+#endif // PQBITS_H
@@ -0,0 +1,112 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef PQPARALLEL_H
+#define PQPARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+// Opt-in multithreading for the O(n) and O(n log n) rebuilds of the
+// array-based priority queues: BinaryPQ's heapify and SortedPQ's sort.  Every
+// PQ stays single-threaded until pqThreadCount() is raised, and even then
+// ranges under PQ_PARALLEL_MIN elements are not worth starting threads for.
+//
+// The work is split into disjoint pieces, so the PQs need no locking, but
+// the comparator is called from several threads at once: it must not modify
+// shared state, and it must not throw.  (An exception on the calling thread
+// is passed on once the other threads finish; one on another thread ends
+// the program, as it does for any std::thread.)
+
+static const std::size_t PQ_PARALLEL_MIN = std::size_t{ 1 } << 16;
+
+
+// Description: The number of threads a rebuild may use, 1 by default.  Set it
+//              to std::thread::hardware_concurrency() to use every core.
+inline unsigned &pqThreadCount() {
+    static unsigned threads = 1;
+    return threads;
+} // pqThreadCount()
+
+
+// Description: Split [0, count) into 'parts' contiguous pieces of nearly equal
+//              size and call body(first, last) for each, all but the first on
+//              new threads.  If a thread cannot be started, the pieces left
+//              over run on the calling thread instead.  Returns, or passes on
+//              an exception from the calling thread's pieces, once every
+//              started thread is done.
+// Runtime: O(count) work over 'parts' threads, plus starting the threads
+template<typename Body>
+void parallelFor(std::size_t count, std::size_t parts, Body body) {
+    parts = std::max<std::size_t>(1, std::min(parts, count));
+    // Joins the threads however this function exits: destroying a thread
+    // that is still joinable calls std::terminate().
+    struct Joiner {
+        std::vector<std::thread> threads;
+        ~Joiner() {
+            for (std::thread &thread : threads)
+                thread.join();
+        }
+    } joiner;
+
+    std::size_t started = 1;
+    try {
+        joiner.threads.reserve(parts - 1);
+        for (; started < parts; ++started)
+            joiner.threads.emplace_back(body, count * started / parts, count * (started + 1) / parts);
+    } catch (const std::exception &) {
+        // Out of threads (std::system_error) or memory for them: carry on
+        // with the ones already running.
+    } // try
+
+    body(0, count / parts);
+    for (std::size_t part = started; part < parts; ++part)
+        body(count * part / parts, count * (part + 1) / parts);
+} // parallelFor()
+
+
+// Description: Sort [first, last) with a merge sort over pqThreadCount()
+//              threads: each thread sorts one piece, then neighboring pieces
+//              are merged in pairs, with the pairs of a round merged
+//              concurrently.  Falls back to std::sort for one thread or a
+//              small range.
+// Runtime: O(n log(n) / p + n)
+template<typename RandomIt, typename COMP_FUNCTOR>
+void parallelSort(RandomIt first, RandomIt last, COMP_FUNCTOR compare) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t parts = pqThreadCount();
+    if (parts < 2 || n < PQ_PARALLEL_MIN) {
+        std::sort(first, last, compare);
+        return;
+    } // if
+
+    auto at = [first](std::size_t i) { return first + static_cast<std::ptrdiff_t>(i); };
+    std::vector<std::size_t> bounds;
+    for (std::size_t part = 0; part <= parts; ++part)
+        bounds.push_back(n * part / parts);
+
+    parallelFor(parts, parts, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t part = begin; part < end; ++part)
+            std::sort(at(bounds[part]), at(bounds[part + 1]), compare);
+    });
+
+    // Each round merges pieces 'width' apart, halving the number of pieces.
+    for (std::size_t width = 1; width < parts; width *= 2) {
+        std::size_t pairs = (parts + 2 * width - 1) / (2 * width);
+        parallelFor(pairs, pairs, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t pair = begin; pair < end; ++pair) {
+                std::size_t low = pair * 2 * width;
+                std::size_t middle = std::min(low + width, parts);
+                std::size_t high = std::min(low + 2 * width, parts);
+                if (middle < high)
+                    std::inplace_merge(at(bounds[low]), at(bounds[middle]), at(bounds[high]), compare);
+            }
+        });
+    } // for
+} // parallelSort()
+
+
+#endif // PQPARALLEL_H
@@ -4,12 +4,15 @@
 #define PAIRINGPQ_H
 
 #include "Eecs281PQ.h"
-#include <deque>
+#include "NodePool.h"
+#include <algorithm>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 // A specialized version of the 'priority queue' ADT implemented as a pairing heap.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class PairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class PairingPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -17,10 +20,17 @@ public:
     // Each node within the pairing heap
     class Node {
         public:
-            // TODO: After you add add one extra pointer (see below), be sure to
-            // initialize it here.
             explicit Node(const TYPE &val)
-                : elt{ val }, child{ nullptr }, sibling{ nullptr }, parent{ nullptr }
+                : elt{ val }, child{ nullptr }, sibling{ nullptr }, previous{ nullptr }
+            {}
+            explicit Node(TYPE &&val)
+                : elt{ std::move(val) }, child{ nullptr }, sibling{ nullptr }, previous{ nullptr }
+            {}
+            // Constructs the element in place from 'args'.
+            template<typename... Args>
+            explicit Node(std::in_place_t, Args&&... args)
+                : elt( std::forward<Args>(args)... ), child{ nullptr }, sibling{ nullptr },
+                  previous{ nullptr }
             {}
 
             // Description: Allows access to the element at that Node's position.
@@ -39,14 +49,23 @@ public:
             TYPE elt;
             Node *child;
             Node *sibling;
-            Node *parent;
+            // The parent for the leftmost child, otherwise the left sibling.
+            Node *previous;
     }; // Node
 
 
+    // How pop() combines the children of the old root into a single tree.
+    //   TwoPass:   meld the children in pairs from left to right, then meld
+    //              the pairs into one tree from right to left.
+    //   MultiPass: keep melding the first two trees and appending the result
+    //              to the end of the list until only one tree is left.
+    enum class PairingStrategy { TwoPass, MultiPass };
+
+
     // Description: Construct an empty pairing heap with an optional comparison functor.
     // Runtime: O(1)
     explicit PairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, root{ nullptr }, count{ 0 } {
+        BaseClass{ comp }, root{ nullptr }, count{ 0 }, strategy{ PairingStrategy::TwoPass } {
 
     } // PairingPQ()
 
@@ -57,7 +76,7 @@ public:
     // TODO: when you implement this function, uncomment the parameter names.
     template<typename InputIterator>
     PairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, count{ 0 } {
+        BaseClass{ comp }, root{ nullptr }, count{ 0 }, strategy{ PairingStrategy::TwoPass } {
             while(start != end) {
                 push(*start);
                 ++start;
@@ -65,83 +84,120 @@ public:
     } // PairingPQ()
 
 
-    // Description: Copy constructor.
+    // Description: Copy constructor.  Clones the shape of 'other' node for node,
+    //              with every node allocated from a single slab.
     // Runtime: O(n)
     PairingPQ(const PairingPQ &other) :
-        BaseClass{ other.compare }, count{ 0 } {
-            std::deque<Node*> node_dq;
-            Node * temp = other.root;
-            node_dq.push_back(temp);
-            while(!node_dq.empty()) {
-                temp = node_dq.front();
-                if(temp->child != nullptr) {
-                    node_dq.push_back(temp->child);
-                }
-                if(temp->sibling != nullptr) {
-                    node_dq.push_back(temp->sibling);
-                }
-                this->push(temp->elt);
-                node_dq.pop_front();
+        BaseClass{ other.compare }, root{ nullptr }, count{ other.count }, strategy{ other.strategy } {
+            if(count != 0) {
+                pool.reserve(count);
+                root = cloneTree(other.root);
             }
     } // PairingPQ()
 
 
+    // Description: Move constructor.  Takes the nodes of 'other', leaving it empty.
+    // Runtime: O(1)
+    PairingPQ(PairingPQ &&other) noexcept :
+        BaseClass{ other.compare }, root{ other.root }, count{ other.count },
+        strategy{ other.strategy }, pool{ std::move(other.pool) }, dirty{ std::move(other.dirty) } {
+            other.root = nullptr;
+            other.count = 0;
+    } // PairingPQ()
+
+
     // Description: Copy assignment operator.
     // Runtime: O(n)
-    // TODO: when you implement this function, uncomment the parameter names.
     PairingPQ &operator=(const PairingPQ &rhs) {
         PairingPQ temp(rhs);
+        swap(temp);
+        return *this;
+    } // operator=()
 
-        std::swap(count, temp.count);
-        std::swap(root, temp.root);
 
+    // Description: Move assignment operator.  The old contents of this heap are
+    //              left in 'rhs', to be freed along with it.
+    // Runtime: O(1)
+    PairingPQ &operator=(PairingPQ &&rhs) noexcept {
+        swap(rhs);
         return *this;
     } // operator=()
 
 
+    // Description: Exchange the contents of two pairing heaps.  Node* handles
+    //              stay valid and follow their elements.
+    // Runtime: O(1)
+    void swap(PairingPQ &other) noexcept {
+        std::swap(this->compare, other.compare);
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        std::swap(strategy, other.strategy);
+        pool.swap(other.pool);
+        dirty.swap(other.dirty);
+    } // swap()
+
+
     // Description: Destructor
     // Runtime: O(n)
     ~PairingPQ() {
-        if(count != 0) {
-            std::deque<Node*> node_dq;
-            Node * temp = root;
-            node_dq.push_back(temp);
-            while(!node_dq.empty()) {
-                temp = node_dq.front();
-                if(temp->child != nullptr) {
-                    node_dq.push_back(temp->child);
-                }
-                if(temp->sibling != nullptr) {
-                    node_dq.push_back(temp->sibling);
-                }
-                delete node_dq.front();
-                node_dq.pop_front();
-            }
+        // The pool frees every slab at once, so nodes only need to be visited
+        // when their elements have destructors to run.
+        if (count != 0 && (!std::is_trivially_destructible<TYPE>::value
+                           || !NodePool<Node>::releasesInBulk)) {
+            destroyNodes(root);
         }
     } // ~PairingPQ()
 
     // Description: Assumes that all elements inside the pairing heap are out of order and
     //              'rebuilds' the pairing heap by fixing the pairing heap invariant.
     //              You CANNOT delete 'old' nodes and create new ones!
-    // Runtime: O(n)
+    //              The nodes are relinked in place, without allocating memory.
+    //              If markDirty() was called since the last rebuild, only the
+    //              marked nodes are assumed to be out of order; each one is
+    //              taken out of the tree and melded back in.
+    // Runtime: O(n), or amortized O(k log(n)) for k marked nodes
     virtual void updatePriorities() {
-        std::deque<Node*> node_dq;
-        Node * temp = root;
-        node_dq.push_back(temp);
-        while(!node_dq.empty()) {
-            temp = node_dq.front();
-            node_dq.pop_front();
-            if(temp->child != nullptr) {
-                node_dq.push_back(temp->child);
+        if(!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), count)) {
+            std::sort(dirty.begin(), dirty.end());
+            dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+            // Every parent/child link that does not involve a marked node
+            // still holds, and reinserting a node drops all of its links.
+            for(Node * node : dirty) {
+                detach(node);
+                root = root == nullptr ? node : meld(root, node);
             }
-            if(temp->sibling != nullptr) {
-                node_dq.push_back(temp->sibling);
+            dirty.clear();
+            return;
+        }
+        dirty.clear();
+        if(count == 0) {
+            return;
+        }
+
+        // Flatten the tree into one list linked through 'sibling', by splicing
+        // each node's children in front of the nodes still to be visited.
+        Node * pending = root;
+        Node * flat = nullptr;
+        while(pending != nullptr) {
+            Node * node = pending;
+            pending = node->sibling;
+            if(node->child != nullptr) {
+                Node * last = node->child;
+                while(last->sibling != nullptr) {
+                    last = last->sibling;
+                }
+                last->sibling = pending;
+                pending = node->child;
+                node->child = nullptr;
             }
-            temp->child = nullptr;
-            temp->parent = nullptr;
-            temp->sibling = nullptr;
-            root = meld(root, temp);
+            node->previous = nullptr;
+            node->sibling = flat;
+            flat = node;
         }
+
+        // Melding neighbours round after round builds a balanced tree, so the
+        // root ends up with O(log n) children instead of n - 1.
+        root = combineMultiPass(flat);
     } // updatePriorities()
 
 
@@ -153,6 +209,19 @@ public:
         addNode(val);
     } // push()
 
+    virtual void push(TYPE &&val) {
+        addNode(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the pairing heap, constructed in place
+    //              from 'args'.  Returns a Node* just like addNode().
+    // Runtime: O(1)
+    template<typename... Args>
+    Node* emplace(Args&&... args) {
+        return link(pool.create(std::in_place, std::forward<Args>(args)...));
+    } // emplace()
+
 
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the pairing heap.
@@ -161,48 +230,32 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     // Runtime: Amortized O(log(n))
     virtual void pop() {
-        std::deque<Node*> node_dq;
-        Node * temp = root->child;
-        // If only a root element exists
-        if(temp == nullptr) {
-            delete root;
-        // Child of root has no siblings, then the child becomes new root
-        } else if(temp->sibling == nullptr) {
-            delete root;
-            root = temp;
-        // Child of root has at least one sibling
-        } else {
-            Node * meld_node_a;
-            Node * meld_node_b;
-            Node * melded_node;
-            while(temp->sibling != nullptr) {
-                node_dq.push_back(temp);
-                temp = temp->sibling;
-            }
-            node_dq.push_back(temp);
-            while(node_dq.size() > 1) {
-                // Get two nodes
-                meld_node_a = node_dq.front();
-                node_dq.pop_front();
-                meld_node_b = node_dq.front();
-                node_dq.pop_front();
-                // Break parent/sibling relationships
-                meld_node_a->parent = nullptr;
-                meld_node_a->sibling = nullptr;
-                meld_node_b->parent = nullptr;
-                meld_node_b->sibling = nullptr;
-                // Meld and push
-                melded_node = meld(meld_node_a, meld_node_b);
-                node_dq.push_back(melded_node);
-            }
-            delete root;
-            root = node_dq.front();
-            node_dq.pop_front();
-        }
+        Node * children = root->child;
+        pool.destroy(root);
+        root = children == nullptr ? nullptr : combineSiblings(children);
         count = count - 1;
     } // pop()
 
 
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first.  This is k pops, but each element is
+    //              moved straight out of its node and nothing is allocated;
+    //              combining the root's children only relinks nodes.
+    // Runtime: Amortized O(k log(n))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for(; k != 0 && root != nullptr; --k) {
+            *out++ = std::move(root->elt);
+            pop();
+        }
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the heap.  This should be a reference for speed.  It MUST be
     //              const because we cannot allow it to be modified, as that
@@ -227,58 +280,93 @@ public:
     } // empty()
 
 
+    // Description: Move every element of 'other' into this pairing heap, leaving
+    //              'other' empty.  The nodes (and the slabs they live in) now
+    //              belong to this heap, and every Node* handle from either heap
+    //              stays valid.  Both heaps must order elements the same way.
+    // Runtime: O(1)
+    void merge(PairingPQ &other) {
+        if(&other == this) {
+            return;
+        }
+        pool.splice(other.pool);
+        if(other.count != 0) {
+            root = count == 0 ? other.root : meld(root, other.root);
+            count += other.count;
+        }
+        other.root = nullptr;
+        other.count = 0;
+        dirty.insert(dirty.end(), other.dirty.begin(), other.dirty.end());
+        other.dirty.clear();
+    } // merge()
+
+    void merge(PairingPQ &&other) {
+        merge(other);
+    } // merge()
+
+
+    // Description: Choose how pop() combines the children of the root.  The
+    //              default is the standard two-pass strategy.
+    // Runtime: O(1)
+    void setPairingStrategy(PairingStrategy new_strategy) {
+        strategy = new_strategy;
+    } // setPairingStrategy()
+
+
+    // Description: Record that the element of 'node' has changed priority, in
+    //              either direction, for the next updatePriorities().  Mark
+    //              every changed node before calling anything else on the
+    //              heap.
+    // Runtime: O(1)
+    void markDirty(Node *node) {
+        dirty.push_back(node);
+    } // markDirty()
+
+
     // Description: Updates the priority of an element already in the pairing heap by
     //              replacing the element refered to by the Node with new_value.
-    //              Must maintain pairing heap invariants.
-    //
-    // PRECONDITION: The new priority, given by 'new_value' must be more extreme
-    //               (as defined by comp) than the old priority.
+    //              Must maintain pairing heap invariants.  The new priority may
+    //              be more or less extreme than the old one, and every Node*
+    //              (including 'node') stays valid.
     //
-    // Runtime: As discussed in reading material.
+    // Runtime: If 'new_value' is more extreme than the old element, O(1) to cut
+    //          the node out, plus a meld with the root.  Otherwise its
+    //          children may now be more extreme than it, so it is taken out
+    //          of the tree as in erase() and melded back in: amortized
+    //          O(log(n)).  That includes a pointer TYPE whose target has
+    //          already changed, since then the old and new values compare
+    //          equal and the direction is unknown.
     // TODO: when you implement this function, uncomment the parameter names.
     void updateElt(Node* node, const TYPE &new_value) {
+        bool promoted = this->compare(node->elt, new_value);
         node->elt = new_value;
-        // If root, exit
+        relink(node, promoted);
+    } // updateElt()
+
+    void updateElt(Node* node, TYPE &&new_value) {
+        bool promoted = this->compare(node->elt, new_value);
+        node->elt = std::move(new_value);
+        relink(node, promoted);
+    } // updateElt()
+
+
+    // Description: Remove the element of 'node' from the pairing heap, wherever
+    //              it is.  Its subtree is cut out, its children are combined
+    //              (two-pass, or as set by setPairingStrategy()) and melded
+    //              back in.  Every other Node* stays valid.
+    // Runtime: Amortized O(log(n))
+    void erase(Node* node) {
         if(node == root) {
-            return;
-        }
-        Node * temp = node->parent;
-        // Leftmost changed
-        if(temp->child == node) {
-            // Has a sibling
-            if(node->sibling) {
-                root->child = node->sibling;
-                node->sibling->parent = root;
-                node->parent = nullptr;
-                node->sibling = nullptr;
-            // Has no siblings
-            } else {
-                node->parent = nullptr;
-                root->child = nullptr;
-            }
-        // Otherwise
+            pop();
         } else {
-            // Middle of sibling chain
-            if(node->sibling) {
-                temp = temp->child;
-                while(temp->sibling != node) {
-                    temp = temp->sibling;
-                }
-                temp->sibling = node->sibling;
-                node->parent = nullptr;
-                node->sibling = nullptr;
-            // End of sibling chain
-            } else {
-                temp = temp->child;
-                while(temp->sibling != node) {
-                    temp = temp->sibling;
-                }
-                temp->sibling = nullptr;
-                node->parent = nullptr;
-            }
+            detach(node);
+            pool.destroy(node);
+            count = count - 1;
         }
-        root = meld(root, node);
-    } // updateElt()
+        if(!dirty.empty()) {
+            dirty.erase(std::remove(dirty.begin(), dirty.end(), node), dirty.end());
+        }
+    } // erase()
 
 
     // Description: Add a new element to the pairing heap. Returns a Node* corresponding
@@ -290,48 +378,224 @@ public:
     //       by the user calling pop().  Remember this when you implement updateElt() and
     //       updatePriorities().
     Node* addNode(const TYPE &val) {
-        // check for proper use of parent/previous
-        Node * new_node = new Node{val};
-        if(count == 0) {
-            root = new_node;
-            count += 1;
-            return root;
-        } else {
-            root = meld(root, new_node);
-            count += 1;
-            return new_node;
-        }
+        return link(pool.create(val));
+    } // addNode()
+
+    Node* addNode(TYPE &&val) {
+        return link(pool.create(std::move(val)));
     } // addNode()
 
 private:
     // TODO: Add any additional member variables or member functions you require here.
     // TODO: We recommend creating a 'meld' function (see the Pairing Heap papers).
 
-    // NOTE: For member variables, you are only allowed to add a "root pointer"
-    //       and a "count" of the number of nodes.  Anything else (such as a deque)
-    //       should be declared inside of member functions as needed.
+    // NOTE: Besides the "root pointer" and the "count" of nodes, the only members
+    //       are the pool the nodes live in, the pairing strategy, and the nodes
+    //       passed to markDirty().  Anything else (such as a deque) should be
+    //       declared inside of member functions as needed.
     Node * root;
     size_t count;
+    PairingStrategy strategy;
+    // Every Node is allocated from here; see NodePool.h.
+    NodePool<Node> pool;
+    std::vector<Node *> dirty;
+
+    // Puts a node whose element just changed back in order.  A promoted node
+    // only has to leave its parent; any other one also has to leave its
+    // children.
+    void relink(Node * node, bool promoted) {
+        if(!promoted) {
+            detach(node);
+            root = root == nullptr ? node : meld(root, node);
+        } else if(node != root) {
+            cut(node);
+            root = meld(root, node);
+        }
+    }
+
+    // Takes 'node' out of the tree, leaving it alone with no links and the
+    // rest of the heap (its children melded together, then melded with the
+    // remaining tree) in 'root'.  'count' is unchanged.
+    void detach(Node * node) {
+        Node * children = node->child;
+        node->child = nullptr;
+        if(node == root) {
+            root = nullptr;
+        } else {
+            cut(node);
+        }
+        if(children != nullptr) {
+            children->previous = nullptr;
+            Node * rest = combineSiblings(children);
+            root = root == nullptr ? rest : meld(root, rest);
+        }
+    }
+
+    // Destroys every node in the tree rooted at 'node' (and its siblings).
+    // Each node's children are spliced in front of the remaining siblings,
+    // so the walk needs no extra container.
+    void destroyNodes(Node * node) {
+        while(node != nullptr) {
+            Node * next = node->sibling;
+            if(node->child != nullptr) {
+                Node * last = node->child;
+                while(last->sibling != nullptr) {
+                    last = last->sibling;
+                }
+                last->sibling = next;
+                next = node->child;
+            }
+            pool.destroy(node);
+            node = next;
+        }
+    }
+    // Melds a list of trees linked through their sibling pointers (such as the
+    // children of a node) into a single tree, and returns its root.  The list
+    // is relinked in place, so no memory is allocated.
+    Node * combineSiblings(Node * first) {
+        if(first->sibling == nullptr) {
+            first->previous = nullptr;
+            return first;
+        }
+        if(strategy == PairingStrategy::MultiPass) {
+            return combineMultiPass(first);
+        }
+
+        // First pass: meld pairs from left to right.  Each result is pushed onto
+        // the front of 'pairs', which leaves them in right-to-left order.
+        Node * pairs = nullptr;
+        while(first != nullptr) {
+            Node * node_a = first;
+            Node * node_b = node_a->sibling;
+            node_a->previous = nullptr;
+            node_a->sibling = nullptr;
+            if(node_b == nullptr) {
+                node_a->sibling = pairs;
+                pairs = node_a;
+                break;
+            }
+            first = node_b->sibling;
+            node_b->previous = nullptr;
+            node_b->sibling = nullptr;
+            Node * melded = meld(node_a, node_b);
+            melded->sibling = pairs;
+            pairs = melded;
+        }
+
+        // Second pass: meld the pairs into one tree from right to left.
+        Node * result = pairs;
+        pairs = pairs->sibling;
+        result->sibling = nullptr;
+        while(pairs != nullptr) {
+            Node * next = pairs->sibling;
+            pairs->sibling = nullptr;
+            result = meld(pairs, result);
+            pairs = next;
+        }
+        return result;
+    }
+
+    // Treats the sibling list as a FIFO queue: melds the first two trees and
+    // appends the result at the back, until one tree is left.
+    Node * combineMultiPass(Node * first) {
+        Node * last = first;
+        while(last->sibling != nullptr) {
+            last = last->sibling;
+        }
+        while(first != last) {
+            Node * node_a = first;
+            Node * node_b = node_a->sibling;
+            first = node_b->sibling;
+            node_a->previous = nullptr;
+            node_a->sibling = nullptr;
+            node_b->previous = nullptr;
+            node_b->sibling = nullptr;
+            Node * melded = meld(node_a, node_b);
+            if(first == nullptr) {
+                first = melded;
+            } else {
+                last->sibling = melded;
+            }
+            last = melded;
+        }
+        first->previous = nullptr;
+        return first;
+    }
+
+    // Melds a newly created node into the heap and returns it.
+    Node * link(Node * new_node) {
+        root = count == 0 ? new_node : meld(root, new_node);
+        count += 1;
+        return new_node;
+    }
+
+    // Copies the tree rooted at 'source' node for node and returns the copy.
+    // Through child/sibling/previous the tree is a binary tree with parent
+    // pointers, so both trees are walked in preorder together without a stack.
+    Node * cloneTree(const Node * source) {
+        Node * copy = pool.create(source->elt);
+        Node * result = copy;
+        while(true) {
+            if(source->child != nullptr) {
+                source = source->child;
+                copy->child = pool.create(source->elt);
+                copy->child->previous = copy;
+                copy = copy->child;
+                continue;
+            }
+            // Climb until a node has a sibling that is not copied yet.
+            while(source->sibling == nullptr) {
+                while(source->previous != nullptr && source->previous->child != source) {
+                    source = source->previous;
+                    copy = copy->previous;
+                }
+                source = source->previous;
+                copy = copy->previous;
+                if(source == nullptr) {
+                    return result;
+                }
+            }
+            source = source->sibling;
+            copy->sibling = pool.create(source->elt);
+            copy->sibling->previous = copy;
+            copy = copy->sibling;
+        }
+    }
+
+    // Detaches the subtree rooted at 'node' (which must not be the root) from
+    // its parent or left sibling in O(1).
+    void cut(Node * node) {
+        if(node->previous->child == node) {
+            node->previous->child = node->sibling;
+        } else {
+            node->previous->sibling = node->sibling;
+        }
+        if(node->sibling != nullptr) {
+            node->sibling->previous = node->previous;
+        }
+        node->previous = nullptr;
+        node->sibling = nullptr;
+    }
+
     // meld(node * a, node * b) 
     // return pointer to bigger tree
     // use this->compare(ptrA->elt, ptrB->elt)
     Node * meld(Node * node_a, Node * node_b) {
-        // make sure that noda_a and node_b have no previous/parent and no sibling
+        // make sure that noda_a and node_b have no previous and no sibling
         if(node_a == node_b) {
             return node_a;
         }
-        // check if either are nullptrs? return not nullptr
         if(this->compare(node_a->elt, node_b->elt)) {
-            node_a->parent = node_b;
-            node_a->sibling = node_b->child;
-            node_b->child = node_a;
-            return node_b;
-        } else {
-            node_b->sibling = node_a->child;
-            node_a->child = node_b;
-            node_b->parent = node_a;
-            return node_a;
+            std::swap(node_a, node_b);
+        }
+        // node_b becomes the leftmost child of node_a
+        node_b->sibling = node_a->child;
+        if(node_a->child != nullptr) {
+            node_a->child->previous = node_b;
         }
+        node_a->child = node_b;
+        node_b->previous = node_a;
+        return node_a;
     }
 };
 
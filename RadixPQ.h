@@ -0,0 +1,247 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef RADIXPQ_H
+#define RADIXPQ_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Eecs281PQ.h"
+#include "PQBits.h"
+
+// The key of an element of a RadixPQ: the element itself for unsigned
+// integers, float and double, and the first member of a std::pair, so that
+// (key, payload) pairs work as they are.  Use any other functor that returns
+// one of those key types for other elements.
+template<typename TYPE>
+struct RadixKey {
+    TYPE operator()(const TYPE &val) const {
+        return val;
+    }
+}; // RadixKey
+
+template<typename KEY, typename PAYLOAD>
+struct RadixKey<std::pair<KEY, PAYLOAD>> {
+    KEY operator()(const std::pair<KEY, PAYLOAD> &val) const {
+        return val.first;
+    }
+}; // RadixKey
+
+
+// The comparison a RadixPQ reports to Eecs281PQ: the element with the
+// smallest key is the most extreme.
+template<typename TYPE, typename KEY_FUNCTOR = RadixKey<TYPE>>
+struct RadixOrder {
+    KEY_FUNCTOR key;
+
+    bool operator()(const TYPE &a, const TYPE &b) const {
+        return key(b) < key(a);
+    }
+}; // RadixOrder
+
+
+// A monotone priority queue (a radix heap): top() is the element with the
+// smallest key, and every key pushed must be at least the key of the last
+// top() (or pop()).  Dijkstra's algorithm and other label-setting searches
+// never push a key below the one just popped, so they qualify.  Debug builds
+// assert on a key that breaks the rule.
+//
+// Keys are mapped to 64-bit unsigned integers (see pqOrderedBits()).  With
+// 'last' the key of the last top(), bucket 0 holds the elements whose key
+// equals 'last', and bucket b > 0 those whose key first differs from 'last'
+// at bit b - 1, counting from the lowest.  Since no key is below 'last', a
+// lower bucket always holds smaller keys.  A push is O(1).  When bucket 0 runs
+// out, top() takes the lowest non-empty bucket (found with one bit scan),
+// makes its smallest key the new 'last', and spreads its elements over
+// strictly lower buckets.  Each element can only move down 64 times, so pops
+// are amortized O(log C) for keys up to C, without comparing elements to
+// each other at all.
+template<typename TYPE, typename KEY_FUNCTOR = RadixKey<TYPE>>
+class RadixPQ final : public Eecs281PQ<TYPE, RadixOrder<TYPE, KEY_FUNCTOR>> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, RadixOrder<TYPE, KEY_FUNCTOR>>;
+
+public:
+    // Description: Construct an empty heap with an optional key functor.
+    // Runtime: O(1)
+    explicit RadixPQ(KEY_FUNCTOR key = KEY_FUNCTOR()) :
+        BaseClass{ RadixOrder<TYPE, KEY_FUNCTOR>{ key } }, count{ 0 }, last{ 0 }, occupied{ 0 } {
+    } // RadixPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              key functor.  The keys may come in any order.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    RadixPQ(InputIterator start, InputIterator end, KEY_FUNCTOR key = KEY_FUNCTOR()) :
+        BaseClass{ RadixOrder<TYPE, KEY_FUNCTOR>{ key } }, count{ 0 }, last{ 0 }, occupied{ 0 } {
+        for (; start != end; ++start)
+            insert(*start);
+    } // RadixPQ
+
+
+    // Description: Destructor doesn't need any code, the buckets will be
+    //              destroyed automatically.
+    virtual ~RadixPQ() {
+    } // ~RadixPQ()
+
+
+    // Description: Assumes that the keys have changed in any direction and
+    //              rebuilds the buckets around the smallest key, which also
+    //              becomes the new lower bound for pushes.
+    // Runtime: O(n)
+    virtual void updatePriorities() {
+        std::vector<TYPE> all;
+        all.reserve(count);
+        for (std::vector<TYPE> &bucket : buckets) {
+            for (TYPE &elt : bucket)
+                all.push_back(std::move(elt));
+            bucket.clear();
+        } // for
+        occupied = 0;
+        if (all.empty())
+            return;
+        last = bitsOf(all.front());
+        for (const TYPE &elt : all)
+            last = std::min(last, bitsOf(elt));
+        spread(all);
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.  Its key must not be smaller
+    //              than the key of the last top() or pop().
+    // Runtime: O(1)
+    virtual void push(const TYPE &val) {
+        insert(val);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        insert(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed from 'args'.  Its
+    //              key decides which bucket it goes in, so it is built first
+    //              and then moved there.
+    // Runtime: O(1)
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        insert(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Remove the element with the smallest key.
+    // Runtime: Amortized O(log(C)) for keys up to C
+    virtual void pop() {
+        refill();
+        buckets[0].pop_back();
+        --count;
+    } // pop()
+
+
+    // Description: Remove the k elements with the smallest keys and write them
+    //              to 'out', smallest first, moving each one out before its
+    //              pop.
+    // Runtime: Amortized O(k log(C))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for (; k != 0 && count != 0; --k) {
+            refill();
+            *out++ = std::move(buckets[0].back());
+            buckets[0].pop_back();
+            --count;
+        } // for
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Return the element with the smallest key.  If several share
+    //              it, which one comes first is unspecified.
+    // Runtime: Amortized O(log(C)) for keys up to C
+    virtual const TYPE &top() const {
+        refill();
+        return buckets[0].back();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return count;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return count == 0;
+    } // empty()
+
+
+private:
+    // One bucket for keys equal to 'last', plus one per bit of a 64-bit key.
+    // top() is const but may have to refill bucket 0, hence mutable.
+    mutable std::array<std::vector<TYPE>, 65> buckets;
+    std::size_t count;
+    mutable std::uint64_t last;
+    // Bit b - 1 is set if bucket b > 0 is not empty.
+    mutable std::uint64_t occupied;
+
+    std::uint64_t bitsOf(const TYPE &val) const {
+        return pqOrderedBits(this->compare.key(val));
+    } // bitsOf()
+
+    std::size_t bucketOf(std::uint64_t bits) const {
+        return pqBitWidth(bits ^ last);
+    } // bucketOf()
+
+    template<typename T>
+    void insert(T &&val) {
+        std::uint64_t bits = bitsOf(val);
+        assert(bits >= last && "RadixPQ: pushed a key smaller than the last top() or pop()");
+        std::size_t bucket = bucketOf(bits);
+        buckets[bucket].push_back(std::forward<T>(val));
+        if (bucket != 0)
+            occupied |= std::uint64_t{ 1 } << (bucket - 1);
+        ++count;
+    } // insert()
+
+    // Move every element of 'from' to the bucket for its key relative to
+    // 'last'.  'from' must not be one of the buckets.
+    void spread(std::vector<TYPE> &from) const {
+        for (TYPE &elt : from) {
+            std::size_t bucket = bucketOf(bitsOf(elt));
+            buckets[bucket].push_back(std::move(elt));
+            if (bucket != 0)
+                occupied |= std::uint64_t{ 1 } << (bucket - 1);
+        } // for
+        from.clear();
+    } // spread()
+
+    // Make sure bucket 0 is not empty, by redistributing the lowest non-empty
+    // bucket around its smallest key.  Its elements all land in lower buckets,
+    // so it is swapped out first and its storage reused afterwards.
+    void refill() const {
+        if (!buckets[0].empty())
+            return;
+        std::size_t lowest = pqLowestBit(occupied) + 1;
+        occupied &= ~(std::uint64_t{ 1 } << (lowest - 1));
+        std::vector<TYPE> from;
+        from.swap(buckets[lowest]);
+        last = bitsOf(from.front());
+        for (const TYPE &elt : from)
+            last = std::min(last, bitsOf(elt));
+        spread(from);
+        from.swap(buckets[lowest]);
+    } // refill()
+}; // RadixPQ
+
+
+#endif // RADIXPQ_H
@@ -0,0 +1,662 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef RANKPAIRINGPQ_H
+#define RANKPAIRINGPQ_H
+
+#include "Eecs281PQ.h"
+#include "NodePool.h"
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A priority queue implemented as a rank-pairing heap (Haeupler, Sen and
+// Tarjan, 2011), with the same Node* handle interface as PairingPQ.  Unlike
+// a pairing heap it has proven bounds for raising an element's priority:
+// O(1) amortized, against pop()'s amortized O(log(n)).
+//
+// The heap is a circular list of half-trees, with 'root' pointing at the
+// most extreme root.  A half-tree is a binary tree whose root has only a left
+// child, and in which every node is at least as extreme as everything in its
+// left subtree (the right subtree is unordered with respect to it).  Each
+// node has a rank: a root's is one more than its left child's, and any other
+// node's follows the type-1 rank rule from the ranks of its two children
+// (missing children count as -1): the larger of the two if they differ, or
+// one more if they are equal.  That keeps a node of rank r the root of at
+// least 2^r nodes, so ranks stay below log2(n) + 1.
+//
+// push() adds a one-node half-tree to the list.  pop() cuts the right spine of
+// the old root's left child into half-trees, then links half-trees of equal
+// rank in one pass over the whole list.  Raising a node's priority cuts it
+// and its left subtree out as a new half-tree, which can only lower ranks on
+// the path above it; the walk up stops as soon as a rank stays the same.
+//
+// Roots link to their neighbours in the list through 'right' and 'parent',
+// which a root does not otherwise use.  Each node keeps the ranks of both of
+// its children rather than its own, so that the walk up after a cut reads
+// only the nodes on the path, not their other children.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class RankPairingPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Each node within the rank-pairing heap
+    class Node {
+        public:
+            explicit Node(const TYPE &val)
+                : elt{ val }, left{ nullptr }, right{ nullptr }, parent{ nullptr }, leftRank{ -1 },
+                  rightRank{ -1 }, isRoot{ false }
+            {}
+            explicit Node(TYPE &&val)
+                : elt{ std::move(val) }, left{ nullptr }, right{ nullptr }, parent{ nullptr }, leftRank{ -1 },
+                  rightRank{ -1 }, isRoot{ false }
+            {}
+            // Constructs the element in place from 'args'.
+            template<typename... Args>
+            explicit Node(std::in_place_t, Args&&... args)
+                : elt( std::forward<Args>(args)... ), left{ nullptr }, right{ nullptr }, parent{ nullptr },
+                  leftRank{ -1 }, rightRank{ -1 }, isRoot{ false }
+            {}
+
+            // Description: Allows access to the element at that Node's position.
+            // Runtime: O(1)
+            const TYPE &getElt() const { return elt; }
+            const TYPE &operator*() const { return elt; }
+
+            friend RankPairingPQ;
+
+        private:
+            TYPE elt;
+            Node *left;
+            // The right child, or for a root the next root in the list.
+            Node *right;
+            // The parent, or for a root the previous root in the list.
+            Node *parent;
+            // The ranks of the children, -1 where there is none.
+            int leftRank;
+            int rightRank;
+            bool isRoot;
+    }; // Node
+
+
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit RankPairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, root{ nullptr }, count{ 0 } {
+    } // RankPairingPQ()
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    RankPairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, root{ nullptr }, count{ 0 } {
+            while(start != end) {
+                push(*start);
+                ++start;
+            }
+    } // RankPairingPQ()
+
+
+    // Description: Copy constructor.  Clones every half-tree of 'other' node
+    //              for node, with every node allocated from a single slab.
+    // Runtime: O(n)
+    RankPairingPQ(const RankPairingPQ &other) :
+        BaseClass{ other.compare }, root{ nullptr }, count{ other.count } {
+            if(count == 0) {
+                return;
+            }
+            pool.reserve(count);
+            const Node * source = other.root;
+            do {
+                addRoot(cloneTree(source));
+                source = source->right;
+            } while(source != other.root);
+    } // RankPairingPQ()
+
+
+    // Description: Move constructor.  Takes the nodes of 'other', leaving it empty.
+    // Runtime: O(1)
+    RankPairingPQ(RankPairingPQ &&other) noexcept :
+        BaseClass{ other.compare }, root{ other.root }, count{ other.count },
+        pool{ std::move(other.pool) }, dirty{ std::move(other.dirty) } {
+            other.root = nullptr;
+            other.count = 0;
+    } // RankPairingPQ()
+
+
+    // Description: Copy assignment operator.
+    // Runtime: O(n)
+    RankPairingPQ &operator=(const RankPairingPQ &rhs) {
+        RankPairingPQ temp(rhs);
+        swap(temp);
+        return *this;
+    } // operator=()
+
+
+    // Description: Move assignment operator.  The old contents of this heap are
+    //              left in 'rhs', to be freed along with it.
+    // Runtime: O(1)
+    RankPairingPQ &operator=(RankPairingPQ &&rhs) noexcept {
+        swap(rhs);
+        return *this;
+    } // operator=()
+
+
+    // Description: Exchange the contents of two heaps.  Node* handles stay
+    //              valid and follow their elements.
+    // Runtime: O(1)
+    void swap(RankPairingPQ &other) noexcept {
+        std::swap(this->compare, other.compare);
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        pool.swap(other.pool);
+        dirty.swap(other.dirty);
+        buckets.swap(other.buckets);
+    } // swap()
+
+
+    // Description: Destructor
+    // Runtime: O(n)
+    ~RankPairingPQ() {
+        // As in PairingPQ, the pool frees every slab at once.
+        if(count != 0 && (!std::is_trivially_destructible<TYPE>::value
+                          || !NodePool<Node>::releasesInBulk)) {
+            forEachNode([this](Node * node) { pool.destroy(node); });
+        }
+    } // ~RankPairingPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order
+    //              and makes every node a one-node half-tree again, relinking
+    //              the nodes in place; the next pop() links them up.  If
+    //              markDirty() was called since the last rebuild, only the
+    //              marked nodes are taken out and put back in.
+    // Runtime: O(n), or amortized O(k log(n)) for k marked nodes
+    virtual void updatePriorities() {
+        if(!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), count)) {
+            std::sort(dirty.begin(), dirty.end());
+            dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+            // Links made while a marked node is moved only compare current
+            // values, and every old link that involves a marked node is
+            // dropped when its own turn comes.  A marked top goes first:
+            // until then it is compared by its new value but still stands
+            // for the old one, and nodes that beat it could hide the rest.
+            Node * top = root;
+            bool topMarked = std::binary_search(dirty.begin(), dirty.end(), top);
+            if(topMarked) {
+                demote(top);
+            }
+            for(Node * node : dirty) {
+                if(!topMarked || node != top) {
+                    demote(node);
+                }
+            }
+            dirty.clear();
+            return;
+        }
+        dirty.clear();
+        forEachNode([this](Node * node) {
+            node->left = nullptr;
+            node->leftRank = -1;
+            addRoot(node);
+        });
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(1)
+    virtual void push(const TYPE &val) {
+        addNode(val);
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        addNode(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed in place from
+    //              'args'.  Returns a Node* just like addNode().
+    // Runtime: O(1)
+    template<typename... Args>
+    Node* emplace(Args&&... args) {
+        return link(pool.create(std::in_place, std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.
+    // Runtime: Amortized O(log(n))
+    virtual void pop() {
+        Node * old = root;
+        consolidate(old);
+        pool.destroy(old);
+        count = count - 1;
+    } // pop()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first, moving each one out of its node before
+    //              its pop.
+    // Runtime: Amortized O(k log(n))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for(; k != 0 && root != nullptr; --k) {
+            *out++ = std::move(root->elt);
+            pop();
+        }
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return root->elt;
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return count;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return count == 0;
+    } // empty()
+
+
+    // Description: Move every element of 'other' into this heap, leaving
+    //              'other' empty, by joining the two lists of half-trees.  As
+    //              with PairingPQ::merge(), the nodes now belong to this heap
+    //              and every Node* handle stays valid.  Both heaps must order
+    //              elements the same way.
+    // Runtime: O(1)
+    void merge(RankPairingPQ &other) {
+        if(&other == this) {
+            return;
+        }
+        pool.splice(other.pool);
+        if(other.count != 0) {
+            if(count == 0) {
+                root = other.root;
+            } else {
+                Node * next = root->right;
+                Node * otherNext = other.root->right;
+                root->right = otherNext;
+                otherNext->parent = root;
+                other.root->right = next;
+                next->parent = other.root;
+                if(beats(other.root, root)) {
+                    root = other.root;
+                }
+            }
+            count += other.count;
+        }
+        other.root = nullptr;
+        other.count = 0;
+        dirty.insert(dirty.end(), other.dirty.begin(), other.dirty.end());
+        other.dirty.clear();
+    } // merge()
+
+    void merge(RankPairingPQ &&other) {
+        merge(other);
+    } // merge()
+
+
+    // Description: Record that the element of 'node' has changed priority, in
+    //              either direction, for the next updatePriorities().  Mark
+    //              every changed node before calling anything else on the
+    //              heap.
+    // Runtime: O(1)
+    void markDirty(Node *node) {
+        dirty.push_back(node);
+    } // markDirty()
+
+
+    // Description: Updates the priority of an element already in the heap by
+    //              replacing the element refered to by the Node with
+    //              new_value.  The new priority may be more or less extreme
+    //              than the old one, and every Node* stays valid.
+    //
+    // Runtime: Amortized O(1) if 'new_value' is more extreme than the old
+    //          element.  Otherwise its left subtree is split into half-trees
+    //          and, if it was the top, the half-trees are linked as in pop():
+    //          amortized O(log(n)).  As in PairingPQ, a pointer TYPE whose
+    //          target has already changed compares equal to the new value,
+    //          and so takes the second path.
+    void updateElt(Node* node, const TYPE &new_value) {
+        bool promoted = this->compare(node->elt, new_value);
+        node->elt = new_value;
+        relink(node, promoted);
+    } // updateElt()
+
+    void updateElt(Node* node, TYPE &&new_value) {
+        bool promoted = this->compare(node->elt, new_value);
+        node->elt = std::move(new_value);
+        relink(node, promoted);
+    } // updateElt()
+
+
+    // Description: Remove the element of 'node' from the heap, wherever it is.
+    //              Every other Node* stays valid.
+    // Runtime: Amortized O(log(n))
+    void erase(Node* node) {
+        if(node == root) {
+            pop();
+        } else {
+            if(node->isRoot) {
+                removeRoot(node);
+            } else {
+                cut(node);
+            }
+            splitLeft(node);
+            pool.destroy(node);
+            count = count - 1;
+        }
+        if(!dirty.empty()) {
+            dirty.erase(std::remove(dirty.begin(), dirty.end(), node), dirty.end());
+        }
+    } // erase()
+
+
+    // Description: Add a new element to the heap. Returns a Node*
+    //              corresponding to the newly added element, which stays
+    //              valid until the element is popped or erased.
+    // Runtime: O(1)
+    Node* addNode(const TYPE &val) {
+        return link(pool.create(val));
+    } // addNode()
+
+    Node* addNode(TYPE &&val) {
+        return link(pool.create(std::move(val)));
+    } // addNode()
+
+private:
+    // The most extreme root, and through it the circular list of roots.
+    Node * root;
+    size_t count;
+    // Every Node is allocated from here; see NodePool.h.
+    NodePool<Node> pool;
+    std::vector<Node *> dirty;
+    // Half-trees waiting for a partner of the same rank during consolidate();
+    // empty between calls, but kept to reuse its storage.
+    std::vector<Node *> buckets;
+
+    // A root's rank is one more than its left child's; any other node's
+    // follows the type-1 rule.
+    static int rankOf(const Node * node) {
+        if(node->isRoot) {
+            return node->leftRank + 1;
+        }
+        int left = node->leftRank;
+        int right = node->rightRank;
+        return left == right ? left + 1 : std::max(left, right);
+    }
+
+    // True if 'a' belongs above 'b'.
+    bool beats(const Node * a, const Node * b) const {
+        return this->compare(b->elt, a->elt);
+    }
+
+    // Puts a node whose element just changed back in order.
+    void relink(Node * node, bool promoted) {
+        if(!promoted) {
+            demote(node);
+        } else if(node->isRoot) {
+            if(beats(node, root)) {
+                root = node;
+            }
+        } else {
+            cut(node);
+            addRoot(node);
+        }
+    }
+
+    // Makes 'node' a one-node half-tree, for an element that may now be less
+    // extreme than its left subtree.  If it was the top, every half-tree is
+    // relinked to find the new one.
+    void demote(Node * node) {
+        if(node == root) {
+            consolidate(node);
+        } else {
+            if(node->isRoot) {
+                removeRoot(node);
+            } else {
+                cut(node);
+            }
+            splitLeft(node);
+        }
+        node->left = nullptr;
+        node->leftRank = -1;
+        addRoot(node);
+    }
+
+    // Melds a newly created node into the heap and returns it.
+    Node * link(Node * new_node) {
+        addRoot(new_node);
+        count += 1;
+        return new_node;
+    }
+
+    // Adds a half-tree to the list of roots, after the current top, and makes
+    // it the top if it is more extreme.  Its right child must already be
+    // gone.
+    void addRoot(Node * node) {
+        node->isRoot = true;
+        if(root == nullptr) {
+            node->right = node;
+            node->parent = node;
+            root = node;
+            return;
+        }
+        node->right = root->right;
+        node->parent = root;
+        root->right->parent = node;
+        root->right = node;
+        if(beats(node, root)) {
+            root = node;
+        }
+    }
+
+    // Takes a root other than the top out of the list.
+    void removeRoot(Node * node) {
+        node->parent->right = node->right;
+        node->right->parent = node->parent;
+        node->isRoot = false;
+    }
+
+    // Links two half-trees of equal rank r: the loser becomes the winner's
+    // left child, and the winner's old left subtree (of rank r - 1) the
+    // loser's right one, which leaves the loser with rank r.
+    Node * linkPair(Node * a, Node * b) {
+        if(beats(b, a)) {
+            std::swap(a, b);
+        }
+        int rank = rankOf(b);
+        b->isRoot = false;
+        b->right = a->left;
+        b->rightRank = a->leftRank;
+        if(a->left != nullptr) {
+            a->left->parent = b;
+        }
+        a->left = b;
+        a->leftRank = rank;
+        b->parent = a;
+        return a;
+    }
+
+    // Cuts a node that is not a root, along with its left subtree, out of its
+    // half-tree: its right child takes its place.  Ranks above it can only
+    // drop, and they are recomputed up to the first one that does not, or to
+    // the root.  Afterwards 'node' is a half-tree of its own, but is not in
+    // the list of roots.
+    void cut(Node * node) {
+        Node * parent = node->parent;
+        Node * replacement = node->right;
+        int rank = node->rightRank;
+        bool fromLeft = parent->left == node;
+        if(fromLeft) {
+            parent->left = replacement;
+        } else {
+            parent->right = replacement;
+        }
+        if(replacement != nullptr) {
+            replacement->parent = parent;
+        }
+        node->right = nullptr;
+        node->rightRank = -1;
+        node->parent = nullptr;
+
+        while(true) {
+            int old = rankOf(parent);
+            if(fromLeft) {
+                parent->leftRank = rank;
+            } else {
+                parent->rightRank = rank;
+            }
+            rank = rankOf(parent);
+            if(parent->isRoot || rank == old) {
+                return;
+            }
+            fromLeft = parent->parent->left == parent;
+            parent = parent->parent;
+        }
+    }
+
+    // Adds each node on the right spine of node's left child to the list of
+    // roots as a half-tree of its own.  'node' itself is left alone.
+    void splitLeft(Node * node) {
+        Node * child = node->left;
+        while(child != nullptr) {
+            Node * next = child->right;
+            child->right = nullptr;
+            child->rightRank = -1;
+            addRoot(child);
+            child = next;
+        }
+    }
+
+    // Rebuilds the list of roots without 'old', the top: its left subtree is
+    // split into half-trees, and all of them are linked in one pass, each
+    // half-tree with the first unmatched one of the same rank.  The result of
+    // a link goes straight to the new list, as the paper's one-pass linking
+    // does.
+    void consolidate(Node * old) {
+        Node * other = old->right;
+        root = nullptr;
+        while(other != old) {
+            Node * next = other->right;
+            bucket(other);
+            other = next;
+        }
+        Node * child = old->left;
+        while(child != nullptr) {
+            Node * next = child->right;
+            child->right = nullptr;
+            child->rightRank = -1;
+            child->isRoot = true;
+            bucket(child);
+            child = next;
+        }
+        for(Node * & waiting : buckets) {
+            if(waiting != nullptr) {
+                addRoot(waiting);
+                waiting = nullptr;
+            }
+        }
+        buckets.clear();
+        old->isRoot = false;
+    }
+
+    void bucket(Node * tree) {
+        size_t rank = static_cast<size_t>(rankOf(tree));
+        if(rank >= buckets.size()) {
+            buckets.resize(rank + 1, nullptr);
+        }
+        if(buckets[rank] == nullptr) {
+            buckets[rank] = tree;
+        } else {
+            Node * linked = linkPair(buckets[rank], tree);
+            buckets[rank] = nullptr;
+            addRoot(linked);
+        }
+    }
+
+    // Calls visit(node) once for every node, after reading its links, so that
+    // visit may destroy or relink it; the list of roots is emptied first.
+    // Nodes still to visit are kept on a stack linked through 'parent'.
+    template<typename Visit>
+    void forEachNode(Visit visit) {
+        if(root == nullptr) {
+            return;
+        }
+        Node * pending = nullptr;
+        Node * node = root;
+        do {
+            Node * next = node->right;
+            node->right = nullptr;
+            node->parent = pending;
+            pending = node;
+            node = next;
+        } while(node != root);
+        root = nullptr;
+        while(pending != nullptr) {
+            node = pending;
+            pending = node->parent;
+            for(Node * child : { node->left, node->right }) {
+                if(child != nullptr) {
+                    child->parent = pending;
+                    pending = child;
+                }
+            }
+            node->right = nullptr;
+            visit(node);
+        }
+    }
+
+    // Copies the half-tree rooted at 'source' node for node and returns the
+    // copy, walking both trees together through their parent pointers.  The
+    // root's 'right' and 'parent' are list links, so the walk stays below it.
+    Node * cloneTree(const Node * source) {
+        const Node * top = source;
+        Node * copy = pool.create(source->elt);
+        copy->leftRank = source->leftRank;
+        Node * result = copy;
+        while(true) {
+            if(source->left != nullptr && copy->left == nullptr) {
+                copy->left = pool.create(source->left->elt);
+                copy->left->parent = copy;
+                source = source->left;
+                copy = copy->left;
+            } else if(source != top && source->right != nullptr && copy->right == nullptr) {
+                copy->right = pool.create(source->right->elt);
+                copy->right->parent = copy;
+                source = source->right;
+                copy = copy->right;
+            } else if(source == top) {
+                return result;
+            } else {
+                source = source->parent;
+                copy = copy->parent;
+                continue;
+            }
+            copy->leftRank = source->leftRank;
+            copy->rightRank = source->rightRank;
+        }
+    }
+}; // RankPairingPQ
+
+
+#endif // RANKPAIRINGPQ_H
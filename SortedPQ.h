@@ -4,6 +4,7 @@
 #define SORTEDPQ_H
 
 #include "Eecs281PQ.h"
+#include "PQParallel.h"
 #include <algorithm>
 #include <iostream>
 
@@ -13,7 +14,7 @@
 // 'data' container, such that traversing the iterators yields the elements in
 // sorted order.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class SortedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class SortedPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -34,7 +35,7 @@ public:
     SortedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
         BaseClass{ comp }, data{start, end} {
             // O(n) + O(n logn) = O(n logn) will the constant factor be too much?
-            sort(data.begin(), data.end(), this->compare);
+            parallelSort(data.begin(), data.end(), this->compare);
     } // SortedPQ
 
 
@@ -55,6 +56,57 @@ public:
         }
     } // push()
 
+    virtual void push(TYPE &&val) {
+        if(!data.empty()) {
+            auto position = lower_bound(data.begin(), data.end(), val, this->compare);
+            data.insert(position, std::move(val));
+        } else {
+            data.push_back(std::move(val));
+        }
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed from 'args'.  It
+    //              has to exist before its position can be found, so it is
+    //              built first and then moved into place.
+    // Runtime: O(n)
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        push(TYPE(std::forward<Args>(args)...));
+    } // emplace()
+
+
+    // Description: Add every element of a range to the heap by sorting them on
+    //              their own and merging them into 'data'.
+    // Runtime: O(n + k log k) for k new elements
+    template<typename InputIterator>
+    void pushRange(InputIterator start, InputIterator end) {
+        std::size_t oldSize = data.size();
+        data.insert(data.end(), start, end);
+        mergeBack(oldSize);
+    } // pushRange()
+
+
+    // Description: Record that the element at 'position' has changed priority,
+    //              for the next updatePriorities().  Positions count as in the
+    //              updatePriorities() overload below.  Mark every changed
+    //              element before calling anything else on the heap.
+    // Runtime: O(1)
+    void markDirty(std::size_t position) {
+        dirty.push_back(position);
+    } // markDirty()
+
+
+    // Description: The elements in sorted order, most extreme last.
+    // Runtime: O(1)
+    typename std::vector<TYPE>::const_iterator begin() const {
+        return data.begin();
+    } // begin()
+
+    typename std::vector<TYPE>::const_iterator end() const {
+        return data.end();
+    } // end()
+
 
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
@@ -67,6 +119,23 @@ public:
     } // pop()
 
 
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first.  They are the last k of the vector, so
+    //              this is one move of that slice, read backwards.
+    // Runtime: O(k)
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        auto first = data.end() - static_cast<std::ptrdiff_t>(std::min(k, data.size()));
+        out = std::move(data.rbegin(), std::make_reverse_iterator(first), out);
+        data.erase(first, data.end());
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
@@ -95,15 +164,65 @@ public:
 
     // Description: Assumes that all elements inside the heap are out of order and
     //              'rebuilds' the heap by fixing the heap invariant.
-    // Runtime: O(n log n)
+    //              Uses pqThreadCount() threads; see PQParallel.h.
+    //              If markDirty() was called since the last rebuild and marked
+    //              at most half of the elements, only those are re-sorted, as
+    //              in the overload below.
+    // Runtime: O(n log n), or O(n + k log k) for k marked elements
     virtual void updatePriorities() {
-        sort(data.begin(), data.end(), this->compare);
+        if (!dirty.empty() && 2 * dirty.size() <= data.size()) {
+            std::vector<std::size_t> positions;
+            positions.swap(dirty);
+            updatePriorities(positions);
+            return;
+        } // if
+        dirty.clear();
+        parallelSort(data.begin(), data.end(), this->compare);
+    } // updatePriorities()
+
+
+    // Description: Restore the order after only the elements at 'positions'
+    //              have changed priority.  A position counts in sorted order
+    //              (the order of begin() to end()), from 0 for the least
+    //              extreme element up to size() - 1 for top(); duplicates are
+    //              allowed, and positions past the end are ignored.  The dirty
+    //              elements are taken out, sorted on their own and merged back
+    //              in.
+    // Runtime: O(n + k log k) for k positions
+    void updatePriorities(const std::vector<std::size_t> &positions) {
+        std::vector<bool> isDirty(data.size(), false);
+        for (std::size_t index : positions) {
+            if (index < data.size())
+                isDirty[index] = true;
+        } // for
+
+        // Slide the clean elements down over the dirty ones, which end up,
+        // in order of position, at the back.
+        std::vector<TYPE> moved;
+        std::size_t clean = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (isDirty[i])
+                moved.push_back(std::move(data[i]));
+            else if (clean++ != i)
+                data[clean - 1] = std::move(data[i]);
+        } // for
+        std::move(moved.begin(), moved.end(), data.begin() + static_cast<std::ptrdiff_t>(clean));
+        mergeBack(clean);
     } // updatePriorities()
 
 
 private:
     // Note: This vector *must* be used for your heap implementation.
     std::vector<TYPE> data;
+    // Positions passed to markDirty() since the last updatePriorities().
+    std::vector<std::size_t> dirty;
+
+    // Sort data[first, end) and merge it with the sorted data[0, first).
+    void mergeBack(std::size_t first) {
+        auto middle = data.begin() + static_cast<std::ptrdiff_t>(first);
+        sort(middle, data.end(), this->compare);
+        std::inplace_merge(data.begin(), middle, data.end(), this->compare);
+    } // mergeBack()
 
 }; // SortedPQ
 
@@ -4,7 +4,9 @@
 #define UNORDEREDFASTPQ_H
 
 #include "Eecs281PQ.h"
+#include "FindExtreme.h"
 
+#include <algorithm>
 #include <limits>  // needed for UNKNOWN
 
 static const size_t UNKNOWN = std::numeric_limits<size_t>::max();
@@ -17,13 +19,23 @@ static const size_t UNKNOWN = std::numeric_limits<size_t>::max();
 // Since top() is almost always followed by pop(), when top() has to find
 // the most extreme element, it remembers that index so that pop() does
 // does not have to search again.  Note the use of the mutable variable.
+// push() keeps a known extreme valid with a single comparison.
+
+// With setBlockIndex(true), 'data' is also split into blocks of about sqrt(n)
+// elements, and the index of each block's most extreme element is cached.
+// A push updates its block in O(1), and a pop only dirties the block it took
+// an element from and the last block, so finding the next extreme costs
+// O(sqrt(n)) instead of O(n).  That makes this a middle ground between the
+// unordered queues and BinaryPQ: O(1) push, O(sqrt(n)) pop.  Either way, ties
+// go to the element with the lowest index, so the pop order does not depend on
+// the setting.
 
 // TODO: Read and understand this priority queue implementation!
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class UnorderedFastPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class UnorderedFastPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -31,7 +43,7 @@ public:
     // Description: Construct an empty heap with an optional comparison functor.
     // Runtime: O(1)
     explicit UnorderedFastPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, extreme{ UNKNOWN } {
+        BaseClass{ comp }, extreme{ UNKNOWN }, useBlocks{ false }, blockShift{ 0 } {
     } // UnorderedFastPQ()
 
 
@@ -40,7 +52,8 @@ public:
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
     UnorderedFastPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, data{ start, end }, extreme{ UNKNOWN } {
+        BaseClass{ comp }, data{ start, end }, extreme{ UNKNOWN }, useBlocks{ false },
+        blockShift{ 0 } {
     } // UnorderedFastPQ()
 
 
@@ -51,32 +64,87 @@ public:
 
 
     // Description: The only thing needed is to mark that we no longer know the
-    //              most extreme element.
-    // Runtime: O(1)
+    //              most extreme element (or the most extreme of any block).
+    //              If markDirty() was called since then, only the marked
+    //              elements are checked against what is known; see
+    //              repairDirty().
+    // Runtime: O(1), or O(n) with the block index; O(k) for k marked elements
     virtual void updatePriorities() {
+        if (!dirty.empty() && !BaseClass::preferRebuild(dirty.size(), data.size())) {
+            repairDirty();
+            return;
+        } // if
+        dirty.clear();
         extreme = UNKNOWN;
+        if (useBlocks)
+            resetBlocks();
     } // updatePriorities()
 
 
+    // Description: Record that the element at 'position' (an offset from
+    //              begin()) has changed priority, for the next
+    //              updatePriorities().  Mark every changed element before
+    //              calling anything else on the heap.
+    // Runtime: O(1)
+    void markDirty(std::size_t position) {
+        dirty.push_back(position);
+    } // markDirty()
+
+
+    // Description: The elements in no particular order, so that markDirty()
+    //              has positions to refer to.
+    // Runtime: O(1)
+    typename std::vector<TYPE>::const_iterator begin() const {
+        return data.begin();
+    } // begin()
+
+    typename std::vector<TYPE>::const_iterator end() const {
+        return data.end();
+    } // end()
+
+
+    // Description: Turn the block index described above on or off.
+    // Runtime: O(n) to turn it on, O(1) to turn it off
+    void setBlockIndex(bool on) {
+        useBlocks = on;
+        if (useBlocks)
+            resetBlocks();
+        else
+            blockBest.clear();
+    } // setBlockIndex()
+
+
     // Description: Add a new element to the heap.
     // Runtime: Amortized O(1)
     virtual void push(const TYPE &val) {
         data.push_back(val);
+        pushed();
+    } // push()
 
-        // Since a new element has been added, we no longer know where to find
-        // the most extreme element.
-        extreme = UNKNOWN;
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+        pushed();
     } // push()
 
 
+    // Description: Add a new element to the heap, constructed in place.
+    // Runtime: Amortized O(1)
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        pushed();
+    } // emplace()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
     // element when the heap is empty. Though you are welcome to if you are
     // familiar with them, you do not need to use exceptions in this project.
-    // Runtime: O(n)
+    // Runtime: O(n), or O(sqrt(n)) with the block index
     // Note: If the most extreme element is already known (as would happen if
-    //       .top() was called before .pop()), this function is O(1).
+    //       .top() was called before .pop()), this function is O(1) (O(sqrt(n))
+    //       with the block index, to refresh the block it came from).
     virtual void pop() {
         // If we don't already know the index of the most extreme element, find it.
         if (extreme == UNKNOWN)
@@ -85,20 +153,54 @@ public:
         // Replace the most extreme element with the element at the back, then
         // pop_back().  This is much faster than erasing from the middle of a
         // vector.
-        data[extreme] = data.back();
+        size_t last = data.size() - 1;
+        if (extreme != last)
+            data[extreme] = std::move(data.back());
         data.pop_back();
 
+        if (useBlocks) {
+            // The block the extreme came from holds a different element now,
+            // and the last block lost one.
+            blockBest[extreme >> blockShift] = UNKNOWN;
+            if ((last & blockMask()) == 0)
+                blockBest.pop_back();
+            else if (blockBest.back() == last)
+                blockBest.back() = UNKNOWN;
+            // Shrink the blocks again once they are four times too big.
+            if (blockShift > 0 && (size_t{ 1 } << (2 * blockShift - 2)) > 4 * data.size())
+                resetBlocks();
+        } // if
+
         // Since the most extreme element has been removed, we no longer know
         // where to find it.
         extreme = UNKNOWN;
     } // pop()
 
 
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first, with one selection pass as in
+    //              UnorderedPQ.  That moves elements around, so afterwards the
+    //              extreme (and every block) is unknown again.
+    // Runtime: O(n + k log(k))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        out = popExtremes(data, k, this->compare, out);
+        extreme = UNKNOWN;
+        if (useBlocks)
+            resetBlocks();
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
     //              might make it no longer be the most extreme element.
-    // Runtime: O(n)
+    // Runtime: O(n), or O(sqrt(n)) with the block index
     virtual const TYPE &top() const {
         // If we don't already know the index of the most extreme element, find it.
         if (extreme == UNKNOWN)
@@ -131,18 +233,105 @@ private:
     // stores the index of the most extreme element, or UNKNOWN.
     mutable size_t extreme;
 
+    // The block index: when useBlocks, blockBest[b] is the index of the most
+    // extreme element of data[b << blockShift, (b + 1) << blockShift), or
+    // UNKNOWN if that block has changed since it was last searched.
+    bool useBlocks;
+    size_t blockShift;
+    mutable std::vector<size_t> blockBest;
+    // Positions passed to markDirty() since the last updatePriorities().
+    std::vector<size_t> dirty;
+
+    // True if data[i] should be chosen over data[j]: it is more extreme, or
+    // equally extreme and first.
+    bool better(size_t i, size_t j) const {
+        return this->compare(data[j], data[i]) || (i < j && !this->compare(data[i], data[j]));
+    } // better()
+
+    // A known extreme (of everything or of a block) that was not marked is
+    // still at least as extreme as every unmarked element, so it only has to
+    // be checked against the marked ones.  A marked one is forgotten.
+    // Positions past the end, left by elements popped after they were
+    // marked, are dropped first, as in BinaryPQ::repairDirty().
+    void repairDirty() {
+        dirty.erase(std::remove_if(dirty.begin(), dirty.end(),
+            [this](size_t position) { return position >= data.size(); }), dirty.end());
+        for (size_t position : dirty) {
+            if (extreme == position)
+                extreme = UNKNOWN;
+            if (useBlocks && blockBest[position >> blockShift] == position)
+                blockBest[position >> blockShift] = UNKNOWN;
+        } // for
+        for (size_t position : dirty) {
+            if (extreme != UNKNOWN && better(position, extreme))
+                extreme = position;
+            if (useBlocks) {
+                size_t &best = blockBest[position >> blockShift];
+                if (best != UNKNOWN && better(position, best))
+                    best = position;
+            } // if
+        } // for
+        dirty.clear();
+    } // repairDirty()
+
+    size_t blockMask() const {
+        return (size_t{ 1 } << blockShift) - 1;
+    } // blockMask()
+
+    // Pick a block size near sqrt(n) and mark every block unknown.
+    void resetBlocks() {
+        blockShift = 0;
+        while ((size_t{ 1 } << (2 * blockShift)) < data.size())
+            ++blockShift;
+        blockBest.assign((data.size() + blockMask()) >> blockShift, UNKNOWN);
+    } // resetBlocks()
+
+    // Keep the known extremes valid after an element is added to the back:
+    // it only replaces one if it is strictly more extreme, which keeps ties
+    // going to the lowest index.
+    void pushed() {
+        size_t index = data.size() - 1;
+        if (extreme != UNKNOWN && this->compare(data[extreme], data[index]))
+            extreme = index;
+
+        if (!useBlocks)
+            return;
+        // Once the blocks are four times too small, double their size; this
+        // happens each time n doubles, so it is O(1) amortized.
+        if ((size_t{ 1 } << (2 * blockShift + 2)) < data.size()) {
+            resetBlocks();
+            return;
+        } // if
+        size_t block = index >> blockShift;
+        if (block == blockBest.size())
+            blockBest.push_back(index);
+        else if (blockBest[block] != UNKNOWN && this->compare(data[blockBest[block]], data[index]))
+            blockBest[block] = index;
+    } // pushed()
+
     // Description: Find the 'most extreme' element of the data vector, using
     //              this->compare() to check if one element is 'less than'
     //              another.
-    // Runtime: O(n)
+    //              For arithmetic TYPEs with std::less or std::greater the
+    //              scan uses SIMD instructions; see FindExtreme.h.
+    // Runtime: O(n), or O(sqrt(n)) with the block index
     void findExtreme() const {
-        size_t index = 0;
-
-        for (size_t i = 1; i < data.size(); ++i)
-            if (this->compare(data[index], data[i]))
-                index = i;
-
-        extreme = index;
+        if (!useBlocks) {
+            extreme = findExtremeIndex(data.data(), data.size(), this->compare);
+            return;
+        } // if
+
+        // Search the blocks that changed, then pick the best block; scanning
+        // the blocks in order keeps ties going to the lowest index.
+        for (size_t block = 0; block < blockBest.size(); ++block) {
+            size_t first = block << blockShift;
+            if (blockBest[block] == UNKNOWN) {
+                size_t length = std::min(data.size() - first, blockMask() + 1);
+                blockBest[block] = first + findExtremeIndex(data.data() + first, length, this->compare);
+            } // if
+            if (block == 0 || this->compare(data[extreme], data[blockBest[block]]))
+                extreme = blockBest[block];
+        } // for
     } // findExtreme()
 }; // UnorderedFastPQ
 
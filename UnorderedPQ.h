@@ -5,6 +5,7 @@
 #define UNORDEREDPQ_H
 
 #include "Eecs281PQ.h"
+#include "FindExtreme.h"
 
 
 // A specialized version of the 'heap' ADT that is implemented with an
@@ -16,7 +17,7 @@
 // are written, especially the use of this->compare.
 
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class UnorderedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class UnorderedPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -50,12 +51,44 @@ public:
     } // updatePriorities()
 
 
+    // Description: Record that the element at 'position' (an offset from
+    //              begin()) has changed priority.  Nothing depends on the
+    //              order here, so this does nothing; it exists so that code
+    //              can mark elements the same way for every PQ.
+    // Runtime: O(1)
+    void markDirty(std::size_t) {
+    } // markDirty()
+
+
+    // Description: The elements in no particular order.
+    // Runtime: O(1)
+    typename std::vector<TYPE>::const_iterator begin() const {
+        return data.begin();
+    } // begin()
+
+    typename std::vector<TYPE>::const_iterator end() const {
+        return data.end();
+    } // end()
+
+
     // Description: Add a new element to the heap.
     // Runtime: Amortized O(1)
     virtual void push(const TYPE &val) {
         data.push_back(val);
     } // push()
 
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed in place.
+    // Runtime: Amortized O(1)
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+    } // emplace()
+
 
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
@@ -69,11 +102,27 @@ public:
         // Replace the most extreme element with the element at the back, then
         // pop_back().  This is much faster than erasing from the middle of a
         // vector.
-        data[findExtreme()] = data.back();
+        size_t index = findExtreme();
+        if (index != data.size() - 1)
+            data[index] = std::move(data.back());
         data.pop_back();
     } // pop()
 
 
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first.  One selection pass finds all k, where
+    //              k pops would each scan the whole vector.
+    // Runtime: O(n + k log(k))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        return popExtremes(data, k, this->compare, out);
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
@@ -106,15 +155,11 @@ private:
     // Description: Find the 'most extreme' element of the data vector, using
     //              this->compare() to check if one element is 'less than'
     //              another.
+    //              For arithmetic TYPEs with std::less or std::greater the
+    //              scan uses SIMD instructions; see FindExtreme.h.
     // Runtime: O(n)
     size_t findExtreme() const {
-        size_t index = 0;
-
-        for (size_t i = 1; i < data.size(); ++i)
-            if (this->compare(data[index], data[i]))
-                index = i;
-
-        return index;
+        return findExtremeIndex(data.data(), data.size(), this->compare);
     } // findExtreme()
 }; // UnorderedPQ
 
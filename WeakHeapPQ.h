@@ -0,0 +1,217 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+#ifndef WEAKHEAPPQ_H
+#define WEAKHEAPPQ_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Eecs281PQ.h"
+
+// A priority queue implemented as a weak heap (Dutton, 1993), for element
+// types that are expensive to compare, such as pointers compared through the
+// elements they point to.
+//
+// A weak heap is a binary tree in one vector with a relaxed order: every node
+// is at least as extreme as the nodes in its right subtree, while its left
+// subtree is unordered with respect to it.  The root has no left subtree, so
+// it is the most extreme element.  Which child of node i counts as "left" is
+// chosen by a reverse bit: the children of i are 2i + r(i) (left) and
+// 2i + 1 - r(i) (right).  Flipping r(i) swaps i's subtrees in O(1), which is
+// what makes the heap cheap to repair: joining two weak heaps takes one
+// comparison, a swap of their roots if needed, and a flip.  The reverse bits
+// are packed 64 to a word next to the elements.
+//
+// Building from n elements takes exactly n - 1 comparisons, pop() at most
+// ceil(log(n)), and push() at most ceil(log(n)) but O(1) on average.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class WeakHeapPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit WeakHeapPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // WeakHeapPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor, with n - 1 comparisons.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    WeakHeapPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data{ start, end } {
+            updatePriorities();
+    } // WeakHeapPQ
+
+
+    // Description: Destructor doesn't need any code, the vectors will be
+    //              destroyed automatically.
+    virtual ~WeakHeapPQ() {
+    } // ~WeakHeapPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order
+    //              and rebuilds the weak heap: clear every reverse bit, then
+    //              join each node, from the last to the first, with its
+    //              distinguished ancestor (see ancestor()).  That is one
+    //              comparison per node below the root.
+    // Runtime: O(n)
+    virtual void updatePriorities() {
+        reverse.assign((data.size() + 63) / 64, 0);
+        for(size_t j = data.size(); j > 1; --j) {
+            join(ancestor(j - 1), j - 1);
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n)), O(1) on average
+    virtual void push(const TYPE &val) {
+        data.push_back(val);
+        siftUp();
+    } // push()
+
+    virtual void push(TYPE &&val) {
+        data.push_back(std::move(val));
+        siftUp();
+    } // push()
+
+
+    // Description: Add a new element to the heap, constructed in place.
+    // Runtime: O(log(n)), O(1) on average
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        data.emplace_back(std::forward<Args>(args)...);
+        siftUp();
+    } // emplace()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap.  The last element moves to the root, then the
+    //              root is joined with each node on the path of left children
+    //              from its right child, bottom-up: at most one comparison per
+    //              level.
+    // Runtime: O(log(n))
+    virtual void pop() {
+        if(data.size() > 1) {
+            data.front() = std::move(data.back());
+        }
+        data.pop_back();
+        if(data.size() < 2) {
+            return;
+        }
+        size_t j = 1;
+        while(2 * j + bit(j) < data.size()) {
+            j = 2 * j + bit(j);
+        }
+        for(; j != 0; j /= 2) {
+            join(0, j);
+        }
+    } // pop()
+
+
+    // Description: Remove the k most extreme elements and write them to 'out',
+    //              most extreme first, moving each one out before its pop.
+    // Runtime: O(k log(n))
+    template<typename OutputIt>
+    OutputIt popK(std::size_t k, OutputIt out) {
+        for(; k != 0 && !data.empty(); --k) {
+            *out++ = std::move(data.front());
+            pop();
+        }
+        return out;
+    } // popK()
+
+    virtual void popBatch(std::size_t k, std::vector<TYPE> &batch) {
+        popK(k, std::back_inserter(batch));
+    } // popBatch()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        return data.front();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    virtual std::size_t size() const {
+        return data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    virtual bool empty() const {
+        return data.empty();
+    } // empty()
+
+
+private:
+    std::vector<TYPE> data;
+    // Bit i % 64 of reverse[i / 64] is the reverse bit of node i.
+    std::vector<std::uint64_t> reverse;
+
+    size_t bit(size_t i) const {
+        return (reverse[i / 64] >> (i % 64)) & 1;
+    }
+
+    void flip(size_t i) {
+        reverse[i / 64] ^= std::uint64_t{ 1 } << (i % 64);
+    }
+
+    void clearBit(size_t i) {
+        reverse[i / 64] &= ~(std::uint64_t{ 1 } << (i % 64));
+    }
+
+    // The distinguished ancestor of node j > 0: the nearest ancestor that has
+    // j in its right subtree, and so must be at least as extreme as j.  Going
+    // up, j is a left child while its parity matches its parent's reverse bit.
+    size_t ancestor(size_t j) const {
+        while((j & 1) == bit(j / 2)) {
+            j /= 2;
+        }
+        return j / 2;
+    }
+
+    // Join the weak heap rooted at j with its distinguished ancestor i: if j
+    // is more extreme, the two swap and j's subtrees trade places, so that j's
+    // old left subtree, never compared with i, becomes its right one.
+    // Returns true if they swapped.
+    bool join(size_t i, size_t j) {
+        if(!this->compare(data[i], data[j])) {
+            return false;
+        }
+        std::swap(data[i], data[j]);
+        flip(j);
+        return true;
+    }
+
+    // Restore the heap after appending a node, which starts with no children
+    // and a clear reverse bit (bits of popped nodes are left behind).  Its
+    // parent's bit decides whether it is a left or a right child; either way
+    // ancestor() finds the node it must not beat.  It is joined upwards with
+    // its distinguished ancestors while it wins.
+    void siftUp() {
+        size_t j = data.size() - 1;
+        if(reverse.size() * 64 < data.size()) {
+            reverse.push_back(0);
+        }
+        clearBit(j);
+        while(j != 0) {
+            size_t i = ancestor(j);
+            if(!join(i, j)) {
+                return;
+            }
+            j = i;
+        }
+    }
+}; // WeakHeapPQ
+
+
+#endif // WEAKHEAPPQ_H
@@ -0,0 +1,1297 @@
+// Project identifier: AD48FB4835AF347EB0CA8009E24C3B13F8519882
+
+/*
+ * Benchmarks for the priority queues.  Type 'make bench' to build two
+ * optimized executables from this file: benchPQ, and benchPQ_heap which is
+ * compiled with -DNODEPOOL_USE_HEAP so the node-based queues allocate every
+ * node with new/delete instead of using a NodePool.
+ *
+ * Usage: ./benchPQ <benchmark> [n]
+ *
+ * Run it with no arguments to list the benchmarks.  Each run does a single
+ * benchmark, so the peak RSS that is printed belongs to that benchmark alone.
+ *
+ * Like the test drivers, this file is never part of a submission.
+ */
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinaryPQ.h"
+#include "BucketPQ.h"
+#include "ChunkedSortedPQ.h"
+#include "DaryPQ.h"
+#include "IndexedBinaryPQ.h"
+#include "MinMaxPQ.h"
+#include "PairingPQ.h"
+#include "PQParallel.h"
+#include "RadixPQ.h"
+#include "RankPairingPQ.h"
+#include "SortedPQ.h"
+#include "UnorderedFastPQ.h"
+#include "UnorderedPQ.h"
+#include "WeakHeapPQ.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+
+// Written to by every benchmark so the optimizer cannot drop the work.
+volatile size_t sink = 0;
+
+
+double secondsSince(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+} // secondsSince()
+
+
+// Peak resident set size of this process, in kilobytes.
+long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+} // peakRssKb()
+
+
+void report(const string &what, size_t ops, double seconds) {
+    cout << "  " << left << setw(36) << what << right << fixed << setprecision(3)
+         << setw(9) << seconds << " s" << setw(10) << static_cast<double>(ops) / seconds / 1e6
+         << " Mops/s" << endl;
+} // report()
+
+
+// A std::less<int> that counts how many times it is called.
+struct CountingLess {
+    static size_t calls;
+    bool operator()(int a, int b) const {
+        ++calls;
+        return a < b;
+    }
+};
+size_t CountingLess::calls = 0;
+
+
+// Compares through pointers, like IntPtrComp in testPQ.cpp, and counts calls.
+struct IntPtrLess {
+    bool operator()(const int *a, const int *b) const {
+        return *a < *b;
+    }
+};
+
+struct CountingPtrLess {
+    static size_t calls;
+    bool operator()(const int *a, const int *b) const {
+        ++calls;
+        return *a < *b;
+    }
+};
+size_t CountingPtrLess::calls = 0;
+
+
+vector<int> randomInts(size_t n, unsigned seed = 281) {
+    mt19937 gen(seed);
+    uniform_int_distribution<int> dist(0, 1 << 30);
+    vector<int> values(n);
+    for (int &value : values)
+        value = dist(gen);
+    return values;
+} // randomInts()
+
+
+// Push n elements then pop them all, followed by a steady-state phase that
+// alternates push and pop around a heap of n/2 elements.
+void benchPairingAlloc(size_t n) {
+#ifdef NODEPOOL_USE_HEAP
+    cout << "PairingPQ<int> with new/delete nodes, n = " << n << endl;
+#else
+    cout << "PairingPQ<int> with pooled nodes, n = " << n << endl;
+#endif
+    vector<int> values = randomInts(n);
+
+    {
+        PairingPQ<int> pq;
+        Clock::time_point start = Clock::now();
+        for (int value : values)
+            pq.push(value);
+        report("push", n, secondsSince(start));
+
+        start = Clock::now();
+        while (!pq.empty()) {
+            sink = sink + static_cast<size_t>(pq.top());
+            pq.pop();
+        }
+        report("pop", n, secondsSince(start));
+    }
+
+    {
+        PairingPQ<int> pq(values.begin(), values.begin() + static_cast<ptrdiff_t>(n / 2));
+        Clock::time_point start = Clock::now();
+        for (int value : values) {
+            pq.push(value);
+            pq.pop();
+        }
+        report("push+pop at n/2", n, secondsSince(start));
+    }
+
+    cout << "  peak RSS " << peakRssKb() << " KB" << endl;
+} // benchPairingAlloc()
+
+
+// Pop latency and comparisons per pop for each PairingPQ pairing strategy.
+void benchPairingPop(size_t n) {
+    using PQ = PairingPQ<int, CountingLess>;
+    cout << "PairingPQ<int> pop strategies, n = " << n << endl;
+    vector<int> values = randomInts(n);
+
+    const pair<const char *, PQ::PairingStrategy> strategies[] = {
+        { "two-pass", PQ::PairingStrategy::TwoPass },
+        { "multipass", PQ::PairingStrategy::MultiPass },
+    };
+    for (const auto &strategy : strategies) {
+        PQ pq(values.begin(), values.end());
+        pq.setPairingStrategy(strategy.second);
+        CountingLess::calls = 0;
+        Clock::time_point start = Clock::now();
+        while (!pq.empty()) {
+            sink = sink + static_cast<size_t>(pq.top());
+            pq.pop();
+        }
+        report(string("pop all, ") + strategy.first, n, secondsSince(start));
+        cout << "    " << static_cast<double>(CountingLess::calls) / static_cast<double>(n)
+             << " comparisons per pop" << endl;
+    }
+} // benchPairingPop()
+
+
+// updateElt() on random nodes of a freshly built heap, where the root has
+// up to n children.  Each update raises the value above everything so far.
+void benchPairingUpdate(size_t n) {
+    cout << "PairingPQ<int> updateElt, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    PairingPQ<int> pq;
+    vector<PairingPQ<int>::Node *> nodes;
+    nodes.reserve(n);
+    for (int value : values)
+        nodes.push_back(pq.addNode(value));
+
+    mt19937 gen(1);
+    uniform_int_distribution<size_t> pick(0, n - 1);
+    int next = 1 << 30;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < n; ++i)
+        pq.updateElt(nodes[pick(gen)], ++next);
+    report("updateElt promote", n, secondsSince(start));
+
+    // Demotions have to combine the node's children, like a pop.
+    start = Clock::now();
+    for (size_t i = 0; i < n; ++i)
+        pq.updateElt(nodes[pick(gen)], values[i] / 2);
+    report("updateElt demote", n, secondsSince(start));
+
+    // Erase half of the nodes, in random order.
+    shuffle(nodes.begin(), nodes.end(), gen);
+    start = Clock::now();
+    for (size_t i = 0; i < n / 2; ++i)
+        pq.erase(nodes[i]);
+    report("erase", n / 2, secondsSince(start));
+    sink = sink + static_cast<size_t>(pq.top());
+} // benchPairingUpdate()
+
+
+// Rebuild a heap with updatePriorities(), then time the first pop (which
+// pays for the shape the rebuild left behind) separately from the rest.
+void benchPairingRebuild(size_t n) {
+    cout << "PairingPQ<int> updatePriorities then pop, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    PairingPQ<int> pq(values.begin(), values.end());
+
+    Clock::time_point start = Clock::now();
+    pq.updatePriorities();
+    report("updatePriorities", n, secondsSince(start));
+
+    start = Clock::now();
+    pq.pop();
+    report("first pop", 1, secondsSince(start));
+
+    size_t pops = min<size_t>(n - 1, 1000);
+    start = Clock::now();
+    for (size_t i = 0; i < pops; ++i)
+        pq.pop();
+    report("next pops", pops, secondsSince(start));
+    sink = sink + static_cast<size_t>(pq.top());
+} // benchPairingRebuild()
+
+
+// Snapshot a heap with the copy constructor, then hand it off with a move.
+void benchPairingCopy(size_t n) {
+    cout << "PairingPQ<int> copy and move, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    PairingPQ<int> pq(values.begin(), values.end());
+    pq.pop();
+
+    Clock::time_point start = Clock::now();
+    PairingPQ<int> snapshot(pq);
+    report("copy", n, secondsSince(start));
+
+    start = Clock::now();
+    PairingPQ<int> handed_off(std::move(snapshot));
+    report("move", 1, secondsSince(start));
+    sink = sink + handed_off.size();
+} // benchPairingCopy()
+
+
+// Combine two heaps of n/2 elements with merge(), and with the old approach
+// of popping everything from one heap and pushing it into the other.
+void benchPairingMerge(size_t n) {
+    cout << "PairingPQ<int> merge two heaps of n/2, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    auto middle = values.begin() + static_cast<ptrdiff_t>(n / 2);
+
+    {
+        PairingPQ<int> pq1(values.begin(), middle);
+        PairingPQ<int> pq2(middle, values.end());
+        Clock::time_point start = Clock::now();
+        pq1.merge(pq2);
+        report("merge", 1, secondsSince(start));
+        sink = sink + pq1.size();
+    }
+    {
+        PairingPQ<int> pq1(values.begin(), middle);
+        PairingPQ<int> pq2(middle, values.end());
+        Clock::time_point start = Clock::now();
+        while (!pq2.empty()) {
+            pq1.push(pq2.top());
+            pq2.pop();
+        }
+        report("pop from one, push into other", n / 2, secondsSince(start));
+        sink = sink + pq1.size();
+    }
+} // benchPairingMerge()
+
+
+// An element that is expensive to copy but cheap to move.
+struct Payload {
+    int key;
+    string name;
+    vector<int> history;
+
+    Payload(int k, const string &n, size_t length) : key{ k }, name{ n }, history(length, k) {}
+};
+
+struct PayloadComp {
+    bool operator()(const Payload &a, const Payload &b) const {
+        return a.key < b.key;
+    }
+};
+
+// Fill one PQ by copying, one by moving, and one with emplace.
+template<typename PQ>
+void benchPayloadPushes(const string &pqType, const vector<int> &keys) {
+    const string name = "a name that is too long for the small string buffer";
+    Clock::time_point start;
+    {
+        PQ pq;
+        start = Clock::now();
+        for (int key : keys) {
+            Payload element{ key, name, 8 };
+            pq.push(element);
+        }
+        report(pqType + " push copy", keys.size(), secondsSince(start));
+    }
+    {
+        PQ pq;
+        start = Clock::now();
+        for (int key : keys) {
+            Payload element{ key, name, 8 };
+            pq.push(std::move(element));
+        }
+        report(pqType + " push move", keys.size(), secondsSince(start));
+    }
+    {
+        PQ pq;
+        start = Clock::now();
+        for (int key : keys)
+            pq.emplace(key, name, 8);
+        report(pqType + " emplace", keys.size(), secondsSince(start));
+    }
+} // benchPayloadPushes()
+
+void benchPayload(size_t n) {
+    cout << "Pushing elements with a string and a vector, n = " << n << endl;
+    vector<int> keys = randomInts(n);
+    benchPayloadPushes<UnorderedPQ<Payload, PayloadComp>>("Unordered", keys);
+    benchPayloadPushes<UnorderedFastPQ<Payload, PayloadComp>>("UnorderedFast", keys);
+    benchPayloadPushes<SortedPQ<Payload, PayloadComp>>("Sorted", keys);
+    benchPayloadPushes<BinaryPQ<Payload, PayloadComp>>("Binary", keys);
+    benchPayloadPushes<PairingPQ<Payload, PayloadComp>>("Pairing", keys);
+} // benchPayload()
+
+
+// Fill the heap, then pop it empty.
+template<typename PQ>
+void benchPushPopAll(const string &what, const vector<int> &values) {
+    PQ pq;
+    Clock::time_point start = Clock::now();
+    for (int value : values)
+        pq.push(value);
+    report(what + " push", values.size(), secondsSince(start));
+
+    start = Clock::now();
+    while (!pq.empty()) {
+        sink = sink + static_cast<size_t>(pq.top());
+        pq.pop();
+    }
+    report(what + " pop", values.size(), secondsSince(start));
+} // benchPushPopAll()
+
+void benchDary(size_t n) {
+    cout << "Binary vs d-ary heaps of int, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    benchPushPopAll<BinaryPQ<int>>("BinaryPQ", values);
+    benchPushPopAll<DaryPQ<int, less<int>, 2>>("DaryPQ<2>", values);
+    benchPushPopAll<DaryPQ<int, less<int>, 4>>("DaryPQ<4>", values);
+    benchPushPopAll<DaryPQ<int, less<int>, 8>>("DaryPQ<8>", values);
+} // benchDary()
+
+
+// Pop time and comparisons per pop for both BinaryPQ pop modes, with a
+// comparator that dereferences pointers.
+void benchBinaryPop(size_t n) {
+    using PQ = BinaryPQ<const int *, CountingPtrLess>;
+    cout << "BinaryPQ<const int *> pop modes, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    vector<const int *> pointers;
+    for (const int &value : values)
+        pointers.push_back(&value);
+
+    const pair<const char *, PQ::PopMode> modes[] = {
+        { "top-down", PQ::PopMode::TopDown },
+        { "bottom-up", PQ::PopMode::BottomUp },
+    };
+    for (const auto &mode : modes) {
+        PQ pq(pointers.begin(), pointers.end());
+        pq.setPopMode(mode.second);
+        CountingPtrLess::calls = 0;
+        Clock::time_point start = Clock::now();
+        while (!pq.empty()) {
+            sink = sink + static_cast<size_t>(*pq.top());
+            pq.pop();
+        }
+        report(string("pop all, ") + mode.first, n, secondsSince(start));
+        cout << "    " << static_cast<double>(CountingPtrLess::calls) / static_cast<double>(n)
+             << " comparisons per pop" << endl;
+    }
+} // benchBinaryPop()
+
+
+// The same push/pop loop, once through an Eecs281PQ reference (which must
+// not be inlined, or the compiler could see the dynamic type) and once as a
+// template on the concrete, 'final' class.
+__attribute__((noinline))
+void dispatchVirtual(Eecs281PQ<int> &pq, const vector<int> &values, size_t rounds) {
+    for (size_t round = 0; round < rounds; ++round) {
+        for (int value : values)
+            pq.push(value);
+        while (!pq.empty()) {
+            sink = sink + static_cast<size_t>(pq.top());
+            pq.pop();
+        }
+    }
+} // dispatchVirtual()
+
+template<typename PQ>
+__attribute__((noinline))
+void dispatchStatic(PQ &pq, const vector<int> &values, size_t rounds) {
+    static_assert(IsStaticPQ<PQ, int>::value, "not a priority queue");
+    for (size_t round = 0; round < rounds; ++round) {
+        for (int value : values)
+            pq.push(value);
+        while (!pq.empty()) {
+            sink = sink + static_cast<size_t>(pq.top());
+            pq.pop();
+        }
+    }
+} // dispatchStatic()
+
+template<typename PQ>
+void benchDispatchOne(const string &pqType, const vector<int> &values) {
+    // Repeat small heaps so every run does about 20M operations.
+    size_t rounds = max<size_t>(1, 10000000 / values.size());
+    size_t ops = 2 * rounds * values.size();
+    {
+        PQ pq;
+        Clock::time_point start = Clock::now();
+        dispatchVirtual(pq, values, rounds);
+        report(pqType + " virtual", ops, secondsSince(start));
+    }
+    {
+        PQ pq;
+        Clock::time_point start = Clock::now();
+        dispatchStatic(pq, values, rounds);
+        report(pqType + " static", ops, secondsSince(start));
+    }
+} // benchDispatchOne()
+
+void benchDispatch(size_t n) {
+    cout << "Virtual vs static dispatch, int keys, heaps of n = " << n << endl;
+    vector<int> values = randomInts(n);
+    benchDispatchOne<BinaryPQ<int>>("BinaryPQ", values);
+    benchDispatchOne<DaryPQ<int>>("DaryPQ<4>", values);
+    benchDispatchOne<PairingPQ<int>>("PairingPQ", values);
+    benchDispatchOne<SortedPQ<int>>("SortedPQ", values);
+} // benchDispatch()
+
+
+// Drain an UnorderedPQ, which scans the whole vector for every pop, with each
+// findExtreme kernel the CPU supports.
+template<typename TYPE>
+void benchUnorderedScanType(const string &typeName, const vector<int> &keys) {
+    vector<TYPE> values(keys.begin(), keys.end());
+    int best_level = findExtremeSimdLevel();
+    const char *names[] = { "scalar", "SSE4.1", "AVX2" };
+    for (int level = 0; level <= best_level; ++level) {
+        findExtremeSimdLevel() = level;
+        UnorderedPQ<TYPE> pq(values.begin(), values.end());
+        Clock::time_point start = Clock::now();
+        while (!pq.empty()) {
+            sink = sink + static_cast<size_t>(pq.top());
+            pq.pop();
+        }
+        report(typeName + " " + names[level], values.size(), secondsSince(start));
+    }
+    findExtremeSimdLevel() = best_level;
+} // benchUnorderedScanType()
+
+void benchUnorderedScan(size_t n) {
+    cout << "UnorderedPQ pop everything, n = " << n << endl;
+    vector<int> keys = randomInts(n);
+    benchUnorderedScanType<int>("int", keys);
+    benchUnorderedScanType<unsigned>("unsigned", keys);
+    benchUnorderedScanType<float>("float", keys);
+    benchUnorderedScanType<double>("double", keys);
+} // benchUnorderedScan()
+
+
+// Push with a top() after every push, then pop everything.  The pushes are
+// O(1) on both UnorderedFastPQs since push() keeps the known extreme.
+template<typename PQ>
+void benchPushTopPop(const string &what, PQ &pq, const vector<int> &values) {
+    Clock::time_point start = Clock::now();
+    for (int value : values) {
+        pq.push(value);
+        sink = sink + static_cast<size_t>(pq.top());
+    }
+    report(what + " push+top", values.size(), secondsSince(start));
+
+    start = Clock::now();
+    while (!pq.empty()) {
+        sink = sink + static_cast<size_t>(pq.top());
+        pq.pop();
+    }
+    report(what + " pop", values.size(), secondsSince(start));
+} // benchPushTopPop()
+
+void benchUnorderedFast(size_t n) {
+    cout << "UnorderedFastPQ with and without the block index, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    UnorderedFastPQ<int> plain;
+    UnorderedFastPQ<int> blocked;
+    blocked.setBlockIndex(true);
+    BinaryPQ<int> binary;
+    benchPushTopPop("UnorderedFast", plain, values);
+    benchPushTopPop("UnorderedFast blocks", blocked, values);
+    benchPushTopPop("BinaryPQ", binary, values);
+} // benchUnorderedFast()
+
+
+// Load everything, then take the first top().  DaryPQ<2> still fixes up on
+// every push, so it shows what BinaryPQ::push() used to cost.
+template<typename LOAD>
+void benchIngestOne(const string &what, const vector<int> &values, LOAD load) {
+    Clock::time_point start = Clock::now();
+    sink = sink + static_cast<size_t>(load(values));
+    report(what, values.size(), secondsSince(start));
+} // benchIngestOne()
+
+void benchIngestOrder(const string &order, const vector<int> &values) {
+    benchIngestOne(order + " DaryPQ<2> push", values, [](const vector<int> &vec) {
+        DaryPQ<int, less<int>, 2> pq;
+        for (int value : vec)
+            pq.push(value);
+        return pq.top();
+    });
+    benchIngestOne(order + " BinaryPQ push", values, [](const vector<int> &vec) {
+        BinaryPQ<int> pq;
+        for (int value : vec)
+            pq.push(value);
+        return pq.top();
+    });
+    benchIngestOne(order + " BinaryPQ pushRange", values, [](const vector<int> &vec) {
+        BinaryPQ<int> pq;
+        pq.reserve(vec.size());
+        pq.pushRange(vec.begin(), vec.end());
+        return pq.top();
+    });
+    benchIngestOne(order + " BinaryPQ 1000 batches", values, [](const vector<int> &vec) {
+        BinaryPQ<int> pq;
+        size_t step = vec.size() / 1000 + 1;
+        for (size_t i = 0; i < vec.size(); i += step) {
+            pq.pushRange(vec.begin() + static_cast<ptrdiff_t>(i),
+                         vec.begin() + static_cast<ptrdiff_t>(min(i + step, vec.size())));
+            sink = sink + static_cast<size_t>(pq.top());
+        }
+        return pq.top();
+    });
+} // benchIngestOrder()
+
+void benchBinaryIngest(size_t n) {
+    cout << "Load a heap of int, then top(), n = " << n << endl;
+    vector<int> values = randomInts(n);
+    benchIngestOrder("random", values);
+    sort(values.begin(), values.end());
+    benchIngestOrder("ascending", values);
+} // benchBinaryIngest()
+
+
+// n operations, three pushes for every pop, so the queue ends up n / 2 long.
+template<typename PQ>
+void benchInsertMix(const string &what, const vector<int> &values) {
+    PQ pq;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i % 4 == 3) {
+            sink = sink + static_cast<size_t>(pq.top());
+            pq.pop();
+        } else {
+            pq.push(values[i]);
+        }
+    }
+    report(what, values.size(), secondsSince(start));
+} // benchInsertMix()
+
+void benchChunkedSorted(size_t n) {
+    cout << "3 pushes : 1 pop of int, up to n = " << n << " operations" << endl;
+    for (size_t size = 10000; size <= n; size *= 10) {
+        vector<int> values = randomInts(size);
+        string suffix = " n=" + to_string(size);
+        // SortedPQ shifts half the queue on every push; at 10M that takes
+        // over ten minutes.
+        if (size <= 1000000)
+            benchInsertMix<SortedPQ<int>>("SortedPQ" + suffix, values);
+        benchInsertMix<ChunkedSortedPQ<int, less<int>, 128>>("Chunked<128>" + suffix, values);
+        benchInsertMix<ChunkedSortedPQ<int>>("Chunked<512>" + suffix, values);
+        benchInsertMix<ChunkedSortedPQ<int, less<int>, 2048>>("Chunked<2048>" + suffix, values);
+        benchInsertMix<BinaryPQ<int>>("BinaryPQ" + suffix, values);
+    }
+} // benchChunkedSorted()
+
+
+// Reprioritize 3% of a SortedPQ of pointers with a full sort and with the
+// dirty-index overload, then add 1% more elements with push and pushRange.
+void benchSortedBulk(size_t n) {
+    cout << "SortedPQ<const int *> bulk updates, n = " << n << endl;
+    vector<int> values(n);
+    for (size_t i = 0; i < n; ++i)
+        values[i] = static_cast<int>(i);
+    vector<const int *> pointers;
+    for (const int &value : values)
+        pointers.push_back(&value);
+
+    SortedPQ<const int *, CountingPtrLess> full(pointers.begin(), pointers.end());
+    SortedPQ<const int *, CountingPtrLess> partial(pointers.begin(), pointers.end());
+    // Element i sits at index i, so changing values[i] dirties index i.
+    vector<size_t> dirty;
+    vector<int> changes = randomInts(n / 33 + 1);
+    for (size_t j = 0; j < changes.size(); ++j) {
+        size_t i = static_cast<size_t>(changes[j]) % n;
+        values[i] = changes[(j + 1) % changes.size()];
+        dirty.push_back(i);
+    }
+
+    Clock::time_point start = Clock::now();
+    full.updatePriorities();
+    report("updatePriorities()", n, secondsSince(start));
+    start = Clock::now();
+    partial.updatePriorities(dirty);
+    report("updatePriorities(dirty)", n, secondsSince(start));
+    sink = sink + static_cast<size_t>(*full.top() + *partial.top());
+
+    vector<int> extra = randomInts(n / 100 + 1, 282);
+    vector<const int *> extraPointers;
+    for (const int &value : extra)
+        extraPointers.push_back(&value);
+    start = Clock::now();
+    for (const int *pointer : extraPointers)
+        full.push(pointer);
+    report("push 1%", extraPointers.size(), secondsSince(start));
+    start = Clock::now();
+    partial.pushRange(extraPointers.begin(), extraPointers.end());
+    report("pushRange 1%", extraPointers.size(), secondsSince(start));
+} // benchSortedBulk()
+
+
+// Time BinaryPQ and SortedPQ rebuilds of random ints with 1, 2, 4, ...
+// threads, up to the number of cores (or 8 if that is fewer).
+void benchParallelRebuild(size_t n) {
+    unsigned cores = thread::hardware_concurrency();
+    cout << "Rebuild of n = " << n << " ints, " << cores << " cores" << endl;
+    vector<int> values = randomInts(n);
+    for (unsigned threads = 1; threads <= max(cores, 8u); threads *= 2) {
+        pqThreadCount() = threads;
+        string suffix = " " + to_string(threads) + " threads";
+
+        BinaryPQ<int> binary;
+        binary.pushRange(values.begin(), values.end());
+        Clock::time_point start = Clock::now();
+        binary.updatePriorities();
+        report("BinaryPQ heapify" + suffix, n, secondsSince(start));
+
+        start = Clock::now();
+        SortedPQ<int> built(values.begin(), values.end());
+        report("SortedPQ sort" + suffix, n, secondsSince(start));
+        sink = sink + static_cast<size_t>(binary.top() + built.top());
+    }
+    pqThreadCount() = 1;
+} // benchParallelRebuild()
+
+
+// Change k random keys behind a PQ of pointers, then time a full
+// updatePriorities() against markDirty() on the k elements plus
+// updatePriorities().  'change' picks and changes one key and marks it.
+template<typename PQ, typename Change>
+void benchMarkDirtyOne(const string &pqType, PQ &full, PQ &marked, size_t k, Change change) {
+    for (size_t i = 0; i < k; ++i)
+        change(full, marked, i);
+    Clock::time_point start = Clock::now();
+    full.updatePriorities();
+    double fullSeconds = secondsSince(start);
+    start = Clock::now();
+    marked.updatePriorities();
+    double markedSeconds = secondsSince(start);
+    report(pqType + " full, k=" + to_string(k), full.size(), fullSeconds);
+    report(pqType + " marked, k=" + to_string(k), marked.size(), markedSeconds);
+    sink = sink + static_cast<size_t>(*full.top() + *marked.top());
+} // benchMarkDirtyOne()
+
+// The element at 'position' of a vector-backed PQ points into 'values'.
+template<typename PQ>
+void benchMarkDirtyByPosition(const string &pqType, size_t n, size_t k) {
+    vector<int> values = randomInts(n);
+    vector<int> copies = values;
+    vector<int *> pointers, copyPointers;
+    for (size_t i = 0; i < n; ++i) {
+        pointers.push_back(&values[i]);
+        copyPointers.push_back(&copies[i]);
+    }
+    PQ full(pointers.begin(), pointers.end());
+    PQ marked(copyPointers.begin(), copyPointers.end());
+    vector<int> changes = randomInts(k, 283);
+    benchMarkDirtyOne(pqType, full, marked, k, [&](PQ &f, PQ &m, size_t i) {
+        size_t position = static_cast<size_t>(changes[i]) % n;
+        *f.begin()[static_cast<ptrdiff_t>(position)] = changes[(i + 1) % k];
+        *m.begin()[static_cast<ptrdiff_t>(position)] = changes[(i + 1) % k];
+        m.markDirty(position);
+    });
+} // benchMarkDirtyByPosition()
+
+void benchMarkDirtyPairing(size_t n, size_t k) {
+    using PQ = PairingPQ<int *, IntPtrLess>;
+    vector<int> values = randomInts(n);
+    vector<int> copies = values;
+    PQ full, marked;
+    vector<PQ::Node *> handles;
+    for (size_t i = 0; i < n; ++i) {
+        full.push(&values[i]);
+        handles.push_back(marked.addNode(&copies[i]));
+    }
+    // Pop once so that the trees have some depth.
+    full.pop();
+    marked.pop();
+    vector<int> changes = randomInts(k, 283);
+    benchMarkDirtyOne("Pairing", full, marked, k, [&](PQ &, PQ &m, size_t i) {
+        size_t index = static_cast<size_t>(changes[i]) % n;
+        values[index] = changes[(i + 1) % k];
+        copies[index] = changes[(i + 1) % k];
+        m.markDirty(handles[index]);
+    });
+} // benchMarkDirtyPairing()
+
+void benchMarkDirty(size_t n) {
+    cout << "updatePriorities() after changing k of n = " << n << " keys" << endl;
+    for (size_t k : { n / 1000, n / 100 }) {
+        benchMarkDirtyByPosition<BinaryPQ<int *, IntPtrLess>>("Binary", n, k);
+        benchMarkDirtyByPosition<DaryPQ<int *, IntPtrLess>>("Dary", n, k);
+        benchMarkDirtyByPosition<SortedPQ<int *, IntPtrLess>>("Sorted", n, k);
+        benchMarkDirtyPairing(n, k);
+    }
+} // benchMarkDirty()
+
+
+// A random directed graph in compressed sparse row form: the edges out of
+// vertex v are targets/weights[offsets[v], offsets[v + 1]).
+struct Graph {
+    vector<size_t> offsets;
+    vector<uint32_t> targets;
+    vector<uint32_t> weights;
+};
+
+Graph randomGraph(size_t n, size_t degree, uint32_t maxWeight) {
+    Graph graph;
+    mt19937 gen(281);
+    uniform_int_distribution<uint32_t> vertex(0, static_cast<uint32_t>(n - 1));
+    uniform_int_distribution<uint32_t> weight(1, maxWeight);
+    for (size_t v = 0; v < n; ++v) {
+        graph.offsets.push_back(graph.targets.size());
+        for (size_t e = 0; e < degree; ++e) {
+            graph.targets.push_back(vertex(gen));
+            graph.weights.push_back(weight(gen));
+        }
+    }
+    graph.offsets.push_back(graph.targets.size());
+    return graph;
+} // randomGraph()
+
+// A side x side grid with an edge each way between neighbors.  'weight'
+// gives the weight of the edge between two neighbors in row r, column c and
+// the direction (0 right, 1 down), or 0 to leave that edge out.
+template<typename Weight>
+Graph gridGraph(size_t side, Weight weight) {
+    vector<vector<pair<uint32_t, uint32_t>>> edges(side * side);
+    for (size_t r = 0; r < side; ++r) {
+        for (size_t c = 0; c < side; ++c) {
+            uint32_t v = static_cast<uint32_t>(r * side + c);
+            for (size_t direction = 0; direction < 2; ++direction) {
+                if ((direction == 0 ? c : r) + 1 == side)
+                    continue;
+                uint32_t w = weight(r, c, direction);
+                if (w == 0)
+                    continue;
+                uint32_t to = static_cast<uint32_t>(direction == 0 ? v + 1 : v + side);
+                edges[v].push_back({ to, w });
+                edges[to].push_back({ v, w });
+            }
+        }
+    }
+    Graph graph;
+    for (const auto &out : edges) {
+        graph.offsets.push_back(graph.targets.size());
+        for (const auto &edge : out) {
+            graph.targets.push_back(edge.first);
+            graph.weights.push_back(edge.second);
+        }
+    }
+    graph.offsets.push_back(graph.targets.size());
+    return graph;
+} // gridGraph()
+
+// A grid of random weights from 1 to 1000.
+Graph uniformGrid(size_t n) {
+    mt19937 gen(281);
+    uniform_int_distribution<uint32_t> weight(1, 1000);
+    size_t side = static_cast<size_t>(sqrt(static_cast<double>(n)));
+    return gridGraph(side, [&](size_t, size_t, size_t) { return weight(gen); });
+} // uniformGrid()
+
+// A road-like grid: every 32nd row and column is a fast highway, the other
+// streets are slow, and a fifth of the street segments are missing.  Short
+// searches stay on the streets, long ones ride the highways, so the queue
+// holds keys spread over a much wider range than in uniformGrid().
+Graph roadGrid(size_t n) {
+    mt19937 gen(281);
+    uniform_int_distribution<uint32_t> street(200, 1000);
+    uniform_int_distribution<uint32_t> highway(20, 40);
+    uniform_int_distribution<uint32_t> percent(0, 99);
+    size_t side = static_cast<size_t>(sqrt(static_cast<double>(n)));
+    return gridGraph(side, [&](size_t r, size_t c, size_t direction) {
+        if ((direction == 0 ? r : c) % 32 == 0)
+            return highway(gen);
+        return percent(gen) < 20 ? 0 : street(gen);
+    });
+} // roadGrid()
+
+// (distance, vertex), ordered so that the nearest vertex is the most extreme.
+using DistVertex = pair<uint64_t, uint32_t>;
+using Nearest = greater<DistVertex>;
+const uint64_t UNREACHED = numeric_limits<uint64_t>::max();
+
+// Dijkstra with decrease-key through IndexedBinaryPQ handles.
+uint64_t dijkstraIndexed(const Graph &graph) {
+    size_t n = graph.offsets.size() - 1;
+    vector<uint64_t> dist(n, UNREACHED);
+    vector<IndexedBinaryPQ<DistVertex, Nearest>::Handle> handle(n);
+    IndexedBinaryPQ<DistVertex, Nearest> pq;
+    dist[0] = 0;
+    handle[0] = pq.addElt({ 0, 0 });
+    while (!pq.empty()) {
+        DistVertex nearest = pq.top();
+        pq.pop();
+        for (size_t e = graph.offsets[nearest.second]; e < graph.offsets[nearest.second + 1]; ++e) {
+            uint32_t to = graph.targets[e];
+            uint64_t through = nearest.first + graph.weights[e];
+            if (through >= dist[to])
+                continue;
+            if (dist[to] == UNREACHED)
+                handle[to] = pq.addElt({ through, to });
+            else
+                pq.updateKey(handle[to], { through, to });
+            dist[to] = through;
+        }
+    }
+    uint64_t total = 0;
+    for (uint64_t d : dist)
+        total += d == UNREACHED ? 0 : d;
+    return total;
+} // dijkstraIndexed()
+
+// Dijkstra with decrease-key through updateElt() on a PairingPQ or a
+// RankPairingPQ.
+template<typename PQ>
+uint64_t dijkstraNodes(const Graph &graph) {
+    size_t n = graph.offsets.size() - 1;
+    vector<uint64_t> dist(n, UNREACHED);
+    vector<typename PQ::Node *> node(n, nullptr);
+    PQ pq;
+    dist[0] = 0;
+    node[0] = pq.addNode({ 0, 0 });
+    while (!pq.empty()) {
+        DistVertex nearest = pq.top();
+        pq.pop();
+        node[nearest.second] = nullptr;
+        for (size_t e = graph.offsets[nearest.second]; e < graph.offsets[nearest.second + 1]; ++e) {
+            uint32_t to = graph.targets[e];
+            uint64_t through = nearest.first + graph.weights[e];
+            if (through >= dist[to])
+                continue;
+            if (node[to] == nullptr)
+                node[to] = pq.addNode({ through, to });
+            else
+                pq.updateElt(node[to], { through, to });
+            dist[to] = through;
+        }
+    }
+    uint64_t total = 0;
+    for (uint64_t d : dist)
+        total += d == UNREACHED ? 0 : d;
+    return total;
+} // dijkstraNodes()
+
+// Dijkstra without decrease-key: push duplicates, skip stale entries.
+template<typename PQ>
+uint64_t dijkstraLazy(const Graph &graph) {
+    size_t n = graph.offsets.size() - 1;
+    vector<uint64_t> dist(n, UNREACHED);
+    PQ pq;
+    dist[0] = 0;
+    pq.push({ 0, 0 });
+    while (!pq.empty()) {
+        DistVertex nearest = pq.top();
+        pq.pop();
+        if (nearest.first != dist[nearest.second])
+            continue;
+        for (size_t e = graph.offsets[nearest.second]; e < graph.offsets[nearest.second + 1]; ++e) {
+            uint32_t to = graph.targets[e];
+            uint64_t through = nearest.first + graph.weights[e];
+            if (through < dist[to]) {
+                dist[to] = through;
+                pq.push({ through, to });
+            }
+        }
+    }
+    uint64_t total = 0;
+    for (uint64_t d : dist)
+        total += d == UNREACHED ? 0 : d;
+    return total;
+} // dijkstraLazy()
+
+template<typename Run>
+void benchDijkstraOne(const string &what, const Graph &graph, Run run) {
+    Clock::time_point start = Clock::now();
+    uint64_t total = run(graph);
+    report(what, graph.targets.size(), secondsSince(start));
+    sink = sink + static_cast<size_t>(total);
+} // benchDijkstraOne()
+
+void benchDijkstra(size_t n) {
+    cout << "Dijkstra from vertex 0, n = " << n << " vertices (rates are edges per second)"
+         << endl;
+    const pair<string, Graph (*)(size_t)> shapes[] = {
+        { "random graph, 8 edges per vertex", [](size_t size) { return randomGraph(size, 8, 1000); } },
+        { "uniform grid", uniformGrid },
+        { "road-like grid", roadGrid },
+    };
+    for (const auto &shape : shapes) {
+        Graph graph = shape.second(n);
+        cout << " " << shape.first << endl;
+        benchDijkstraOne("IndexedBinaryPQ updateKey", graph, dijkstraIndexed);
+        benchDijkstraOne("PairingPQ updateElt", graph, dijkstraNodes<PairingPQ<DistVertex, Nearest>>);
+        benchDijkstraOne("RankPairingPQ updateElt", graph, dijkstraNodes<RankPairingPQ<DistVertex, Nearest>>);
+        benchDijkstraOne("BinaryPQ lazy deletion", graph, dijkstraLazy<BinaryPQ<DistVertex, Nearest>>);
+        benchDijkstraOne("RadixPQ lazy deletion", graph, dijkstraLazy<RadixPQ<DistVertex>>);
+    }
+} // benchDijkstra()
+
+
+// Take the top k of n random ints one top()/pop() at a time, then with
+// popK() on a fresh copy, for k from 0.1% to 50% of n.  The rate is elements
+// taken per second.  The unordered queues scan all n per pop, so their
+// one-at-a-time runs stop at 0.1%.
+template<typename PQ>
+void benchPopKOne(const string &pqType, const vector<int> &values, size_t maxSlowK) {
+    vector<int> batch;
+    batch.reserve(values.size() / 2 + 1);
+    for (size_t k : { values.size() / 1000 + 1, values.size() / 100 + 1, values.size() / 10 + 1,
+                      values.size() / 2 + 1 }) {
+        string suffix = " k = " + to_string(k);
+        if (k <= maxSlowK) {
+            PQ pq(values.begin(), values.end());
+            sink = sink + static_cast<size_t>(pq.top());
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < k; ++i) {
+                batch.push_back(pq.top());
+                pq.pop();
+            }
+            report(pqType + " pops" + suffix, k, secondsSince(start));
+            batch.clear();
+        } // if
+        PQ pq(values.begin(), values.end());
+        sink = sink + static_cast<size_t>(pq.top());
+        Clock::time_point start = Clock::now();
+        pq.popK(k, back_inserter(batch));
+        report(pqType + " popK" + suffix, k, secondsSince(start));
+        sink = sink + static_cast<size_t>(batch.back());
+        batch.clear();
+    } // for
+} // benchPopKOne()
+
+void benchPopK(size_t n) {
+    cout << "Top-k extraction from n = " << n << " ints" << endl;
+    vector<int> values = randomInts(n);
+    benchPopKOne<UnorderedPQ<int>>("UnorderedPQ", values, n / 1000 + 1);
+    benchPopKOne<UnorderedFastPQ<int>>("UnorderedFastPQ", values, n / 1000 + 1);
+    benchPopKOne<SortedPQ<int>>("SortedPQ", values, n);
+    benchPopKOne<ChunkedSortedPQ<int>>("ChunkedSortedPQ", values, n);
+    benchPopKOne<BinaryPQ<int>>("BinaryPQ", values, n);
+    benchPopKOne<DaryPQ<int>>("DaryPQ<4>", values, n);
+    benchPopKOne<PairingPQ<int>>("PairingPQ", values, n);
+} // benchPopK()
+
+
+// Keep the best K of a stream of n random ints, generated on the fly so
+// that only the queues hold memory: MinMaxPQ with setCapacity(K), the classic
+// K-element BinaryPQ min-heap whose top is the worst kept element, and a
+// BinaryPQ of all n elements followed by popK(K).  The bounded runs go first,
+// so the first peak RSS is theirs alone.
+template<typename Keep>
+void benchTopKStreamOne(const string &what, size_t n, size_t k, Keep keep) {
+    // xorshift32: cheap enough that the queues, not the generator, dominate.
+    uint32_t x = 281;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        keep(static_cast<int>(x >> 2));
+    }
+    report(what + " K = " + to_string(k), n, secondsSince(start));
+} // benchTopKStreamOne()
+
+void benchTopKStream(size_t n) {
+    cout << "Best K of a stream of n = " << n << " ints" << endl;
+    for (size_t k : { size_t{ 100 }, size_t{ 10000 } }) {
+        MinMaxPQ<int> minMax;
+        minMax.setCapacity(k);
+        benchTopKStreamOne("MinMaxPQ pushBounded", n, k, [&minMax](int value) {
+            minMax.pushBounded(value);
+        });
+        BinaryPQ<int, greater<int>> worstFirst;
+        benchTopKStreamOne("BinaryPQ min-heap", n, k, [&worstFirst, k](int value) {
+            if (worstFirst.size() < k) {
+                worstFirst.push(value);
+            } else if (worstFirst.top() < value) {
+                worstFirst.pop();
+                worstFirst.push(value);
+            }
+        });
+        sink = sink + static_cast<size_t>(minMax.top() + worstFirst.top());
+    }
+    cout << "  peak RSS " << peakRssKb() << " KB" << endl;
+
+    BinaryPQ<int> everything;
+    vector<int> best;
+    benchTopKStreamOne("BinaryPQ of all n", n, 10000, [&everything](int value) {
+        everything.push(value);
+    });
+    Clock::time_point start = Clock::now();
+    everything.popK(10000, back_inserter(best));
+    report("BinaryPQ of all n popK(K)", 10000, secondsSince(start));
+    sink = sink + static_cast<size_t>(best.back());
+    cout << "  peak RSS " << peakRssKb() << " KB" << endl;
+} // benchTopKStream()
+
+
+// The hold model: fill a queue with n keys, then repeatedly pop the next key
+// and push a new one made from it, so the queue stays at n elements.  'next'
+// makes the new key from the one popped and a random number.
+template<typename PQ, typename Next>
+void benchHoldOne(const string &what, PQ &pq, size_t n, Next next) {
+    using Key = typename std::decay<decltype(pq.top())>::type;
+    uint32_t x = 281;
+    auto random = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+    for (size_t i = 0; i < n; ++i)
+        pq.push(next(Key{}, random()));
+    size_t ops = 20 * n;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        Key key = pq.top();
+        pq.pop();
+        pq.push(next(key, random()));
+    }
+    report(what + " pop+push", ops, secondsSince(start));
+    sink = sink + static_cast<size_t>(pq.top());
+} // benchHoldOne()
+
+void benchBucket(size_t n) {
+    cout << "Hold model with n = " << n << " elements, lowest key first" << endl;
+    cout << "256 priority classes:" << endl;
+    auto qos = [](int, uint32_t r) { return static_cast<int>(r % 256); };
+    {
+        BinaryPQ<int, greater<int>> binary;
+        benchHoldOne("BinaryPQ", binary, n, qos);
+    }
+    {
+        BucketPQ<int, greater<int>> bucket;
+        benchHoldOne("BucketPQ Fixed", bucket, n, qos);
+    }
+
+    // Event times: each event schedules the next one up to 2^20 ticks later.
+    cout << "Event times:" << endl;
+    auto later = [](uint64_t now, uint32_t r) { return now + (r >> 12); };
+    {
+        BinaryPQ<uint64_t, greater<uint64_t>> binary;
+        benchHoldOne("BinaryPQ", binary, n, later);
+    }
+    {
+        RadixPQ<uint64_t> radix;
+        benchHoldOne("RadixPQ", radix, n, later);
+    }
+    {
+        BucketPQ<uint64_t, greater<uint64_t>> calendar;
+        calendar.setMode(BucketPQ<uint64_t, greater<uint64_t>>::BucketMode::Calendar);
+        benchHoldOne("BucketPQ Calendar", calendar, n, later);
+        cout << "  calendar bucket width " << calendar.bucketWidth() << endl;
+    }
+    {
+        BucketPQ<uint64_t, greater<uint64_t>> fixed;
+        benchHoldOne("BucketPQ Fixed", fixed, n, later);
+    }
+} // benchBucket()
+
+
+// Comparisons and time per operation through a pointer-chasing comparator:
+// build from a range, n pushes (with a top() at the end, which is when
+// BinaryPQ merges its buffered pushes), then pop everything.  'configure' is
+// applied to both queues first.
+template<typename PQ, typename Configure>
+void benchComparisonsOne(const string &what, const vector<const int *> &pointers, Configure configure) {
+    size_t n = pointers.size();
+    auto perOp = [n]() {
+        double calls = static_cast<double>(CountingPtrLess::calls) / static_cast<double>(n);
+        CountingPtrLess::calls = 0;
+        return calls;
+    };
+    cout << what << endl;
+    CountingPtrLess::calls = 0;
+    Clock::time_point start = Clock::now();
+    PQ built(pointers.begin(), pointers.end());
+    report("  build", n, secondsSince(start));
+    cout << "    " << perOp() << " comparisons per element" << endl;
+
+    PQ pq;
+    configure(pq);
+    start = Clock::now();
+    for (const int *pointer : pointers)
+        pq.push(pointer);
+    sink = sink + static_cast<size_t>(*pq.top());
+    report("  push", n, secondsSince(start));
+    cout << "    " << perOp() << " comparisons per push" << endl;
+
+    start = Clock::now();
+    while (!pq.empty()) {
+        sink = sink + static_cast<size_t>(*pq.top());
+        pq.pop();
+    }
+    report("  pop", n, secondsSince(start));
+    cout << "    " << perOp() << " comparisons per pop" << endl;
+    sink = sink + built.size();
+} // benchComparisonsOne()
+
+void benchWeakHeap(size_t n) {
+    cout << "Comparisons per operation, <const int *> compared through the pointer, n = " << n << endl;
+    vector<int> values = randomInts(n);
+    vector<const int *> pointers;
+    for (const int &value : values)
+        pointers.push_back(&value);
+
+    using Binary = BinaryPQ<const int *, CountingPtrLess>;
+    auto asIs = [](auto &) {};
+    benchComparisonsOne<WeakHeapPQ<const int *, CountingPtrLess>>("WeakHeapPQ", pointers, asIs);
+    benchComparisonsOne<Binary>("BinaryPQ top-down", pointers, asIs);
+    benchComparisonsOne<Binary>("BinaryPQ bottom-up", pointers, [](Binary &pq) {
+        pq.setPopMode(Binary::PopMode::BottomUp);
+    });
+    benchComparisonsOne<PairingPQ<const int *, CountingPtrLess>>("PairingPQ", pointers, asIs);
+} // benchWeakHeap()
+
+
+// Orders (priority, slot) pairs by priority only, and counts calls.
+struct CountingFirstLess {
+    static size_t calls;
+    bool operator()(const pair<int, uint32_t> &a, const pair<int, uint32_t> &b) const {
+        ++calls;
+        return a.first < b.first;
+    }
+};
+size_t CountingFirstLess::calls = 0;
+
+// Decrease-key heavy work on n nodes: each round raises the priority of 8
+// random nodes by a random amount, pops the top, and pushes a new node into
+// the popped node's slot.  Comparisons are counted over all operations.
+template<typename PQ>
+void benchPromoteHeavyOne(const string &what, const vector<int> &values, size_t rounds) {
+    size_t n = values.size();
+    PQ pq;
+    vector<typename PQ::Node *> nodes;
+    nodes.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        nodes.push_back(pq.addNode({ values[i], static_cast<uint32_t>(i) }));
+
+    uint32_t x = 281;
+    auto random = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+    CountingFirstLess::calls = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            typename PQ::Node *node = nodes[random() % n];
+            const pair<int, uint32_t> &old = node->getElt();
+            pq.updateElt(node, { old.first + static_cast<int>(random() % 4096), old.second });
+        }
+        uint32_t slot = pq.top().second;
+        pq.pop();
+        nodes[slot] = pq.addNode({ static_cast<int>(random() >> 2), slot });
+    }
+    report(what + " round", rounds, secondsSince(start));
+    cout << "    " << static_cast<double>(CountingFirstLess::calls) / static_cast<double>(10 * rounds)
+         << " comparisons per operation" << endl;
+    sink = sink + static_cast<size_t>(pq.top().first);
+} // benchPromoteHeavyOne()
+
+void benchRankPairing(size_t n) {
+    cout << "Decrease-key heavy rounds (8 updateElt, pop, push), n = " << n << endl;
+    vector<int> values = randomInts(n);
+    for (int &value : values)
+        value /= 4;
+    using Item = pair<int, uint32_t>;
+    benchPromoteHeavyOne<PairingPQ<Item, CountingFirstLess>>("PairingPQ", values, n);
+    benchPromoteHeavyOne<RankPairingPQ<Item, CountingFirstLess>>("RankPairingPQ", values, n);
+} // benchRankPairing()
+
+
+struct Benchmark {
+    const char *name;
+    void (*run)(size_t n);
+    size_t defaultSize;
+    const char *description;
+};
+
+const Benchmark benchmarks[] = {
+    { "pairing-alloc", benchPairingAlloc, 1000000,
+      "PairingPQ push/pop throughput and peak RSS (compare with benchPQ_heap)" },
+    { "pairing-pop", benchPairingPop, 1000000,
+      "PairingPQ pop time and comparisons per pop, two-pass vs multipass" },
+    { "pairing-update", benchPairingUpdate, 100000,
+      "PairingPQ updateElt (both directions) and erase on random nodes" },
+    { "pairing-rebuild", benchPairingRebuild, 10000000,
+      "PairingPQ updatePriorities on a large heap, then the first pops" },
+    { "pairing-copy", benchPairingCopy, 1000000,
+      "PairingPQ copy constructor and move constructor" },
+    { "pairing-merge", benchPairingMerge, 1000000,
+      "PairingPQ merge() against popping one heap into another" },
+    { "payload", benchPayload, 20000,
+      "push copy vs push move vs emplace of expensive elements, every PQ" },
+    { "dary", benchDary, 1000000,
+      "BinaryPQ against DaryPQ with D = 2, 4 and 8 (try n up to 100M)" },
+    { "binary-pop", benchBinaryPop, 1000000,
+      "BinaryPQ pop time and comparisons per pop, top-down vs bottom-up" },
+    { "dispatch", benchDispatch, 1000,
+      "push/pop through Eecs281PQ (virtual) vs on the final class (static)" },
+    { "unordered-scan", benchUnorderedScan, 20000,
+      "UnorderedPQ findExtreme: scalar vs SSE4.1 vs AVX2 kernels" },
+    { "unordered-fast", benchUnorderedFast, 50000,
+      "UnorderedFastPQ push+top and pop, with and without the block index" },
+    { "binary-ingest", benchBinaryIngest, 10000000,
+      "BinaryPQ push, pushRange and batches against eager fix_up pushes" },
+    { "chunked-sorted", benchChunkedSorted, 10000000,
+      "SortedPQ vs ChunkedSortedPQ on insert-heavy mixes, 10k to n operations" },
+    { "sorted-bulk", benchSortedBulk, 1000000,
+      "SortedPQ full vs partial updatePriorities, push vs pushRange" },
+    { "parallel-rebuild", benchParallelRebuild, 10000000,
+      "BinaryPQ heapify and SortedPQ sort, 1 to N threads (pqThreadCount)" },
+    { "mark-dirty", benchMarkDirty, 1000000,
+      "full updatePriorities vs markDirty on 0.1% and 1% of the keys" },
+    { "dijkstra", benchDijkstra, 1000000,
+      "shortest paths on random and grid graphs: decrease-key PQs vs lazy Binary/Radix" },
+    { "popk", benchPopK, 1000000,
+      "top-k extraction: k pops vs popK() for k = 0.1% to 50% of n" },
+    { "topk-stream", benchTopKStream, 100000000,
+      "best K of a stream: bounded MinMaxPQ vs a K-element min-heap vs keeping all" },
+    { "bucket", benchBucket, 100000,
+      "hold model: BucketPQ on priority classes and event times vs Binary/Radix" },
+    { "weak-heap", benchWeakHeap, 1000000,
+      "comparisons per build/push/pop: WeakHeapPQ vs BinaryPQ vs PairingPQ" },
+    { "rank-pairing", benchRankPairing, 1000000,
+      "decrease-key heavy rounds: PairingPQ vs RankPairingPQ updateElt" },
+};
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <benchmark> [n]" << endl << endl;
+        for (const Benchmark &bench : benchmarks)
+            cout << "  " << left << setw(20) << bench.name << bench.description << endl;
+        return 1;
+    } // if
+
+    for (const Benchmark &bench : benchmarks) {
+        if (bench.name == string(argv[1])) {
+            size_t n = argc > 2 ? static_cast<size_t>(strtoull(argv[2], nullptr, 10))
+                                : bench.defaultSize;
+            bench.run(n);
+            return 0;
+        } // if
+    } // for
+
+    cerr << "Unknown benchmark: " << argv[1] << endl;
+    return 1;
+} // main()
@@ -22,20 +22,52 @@
  * You do not have to submit this file, but it won't cause problems if you do.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "Eecs281PQ.h"
 #include "BinaryPQ.h"
+#include "BucketPQ.h"
+#include "ChunkedSortedPQ.h"
+#include "DaryPQ.h"
+#include "IndexedBinaryPQ.h"
+#include "MinMaxPQ.h"
 #include "UnorderedPQ.h"
+#include "WeakHeapPQ.h"
+#include "UnorderedFastPQ.h"
 #include "PairingPQ.h"
+#include "RadixPQ.h"
+#include "RankPairingPQ.h"
+#include "PQParallel.h"
 #include "SortedPQ.h"
 
 using namespace std;
 
 
+// Every PQ must provide the interface without going through Eecs281PQ.
+static_assert(IsStaticPQ<UnorderedPQ<int>, int>::value, "UnorderedPQ interface");
+static_assert(IsStaticPQ<UnorderedFastPQ<int>, int>::value, "UnorderedFastPQ interface");
+static_assert(IsStaticPQ<SortedPQ<int>, int>::value, "SortedPQ interface");
+static_assert(IsStaticPQ<BinaryPQ<int>, int>::value, "BinaryPQ interface");
+static_assert(IsStaticPQ<DaryPQ<int>, int>::value, "DaryPQ interface");
+static_assert(IsStaticPQ<PairingPQ<int>, int>::value, "PairingPQ interface");
+static_assert(IsStaticPQ<ChunkedSortedPQ<int>, int>::value, "ChunkedSortedPQ interface");
+static_assert(IsStaticPQ<IndexedBinaryPQ<int>, int>::value, "IndexedBinaryPQ interface");
+static_assert(IsStaticPQ<MinMaxPQ<int>, int>::value, "MinMaxPQ interface");
+static_assert(IsStaticPQ<RadixPQ<unsigned>, unsigned>::value, "RadixPQ interface");
+static_assert(IsStaticPQ<BucketPQ<int>, int>::value, "BucketPQ interface");
+static_assert(IsStaticPQ<WeakHeapPQ<int>, int>::value, "WeakHeapPQ interface");
+static_assert(IsStaticPQ<RankPairingPQ<int>, int>::value, "RankPairingPQ interface");
+static_assert(!IsStaticPQ<vector<int>, int>::value, "vector is not a PQ");
+
+
 // Used to test a priority queue containing pointers to integers.
 struct IntPtrComp {
     bool operator() (const int *a, const int *b) const {
@@ -43,6 +75,13 @@ struct IntPtrComp {
     }
 };
 
+// BucketPQ also needs the key that IntPtrComp compares.
+struct IntPtrKey {
+    int operator()(const int *a) const {
+        return *a;
+    }
+};
+
 void testHiddenData(const string &pqType) {
     struct HiddenData {
         int data;
@@ -107,6 +146,22 @@ void testUpdatePriorities(const string &pqType) {
         pq = new SortedPQ<int *, IntPtrComp>;
     } else if(pqType == "Binary") {
         pq = new BinaryPQ<int *, IntPtrComp>;
+    } else if(pqType == "UnorderedFast") {
+        pq = new UnorderedFastPQ<int *, IntPtrComp>;
+    } else if(pqType == "Dary") {
+        pq = new DaryPQ<int *, IntPtrComp>;
+    } else if(pqType == "ChunkedSorted") {
+        pq = new ChunkedSortedPQ<int *, IntPtrComp>;
+    } else if(pqType == "IndexedBinary") {
+        pq = new IndexedBinaryPQ<int *, IntPtrComp>;
+    } else if(pqType == "MinMax") {
+        pq = new MinMaxPQ<int *, IntPtrComp>;
+    } else if(pqType == "Bucket") {
+        pq = new BucketPQ<int *, IntPtrComp, IntPtrKey>;
+    } else if(pqType == "WeakHeap") {
+        pq = new WeakHeapPQ<int *, IntPtrComp>;
+    } else if(pqType == "RankPairing") {
+        pq = new RankPairingPQ<int *, IntPtrComp>;
     } else {
         pq = new PairingPQ<int *, IntPtrComp>;
     }
@@ -120,6 +175,1143 @@ void testUpdatePriorities(const string &pqType) {
 } // testUpdatePriorities()
 
 
+// An element that counts how many times it has been copied.
+struct Tracked {
+    static int copies;
+    int key;
+    string payload;
+
+    Tracked(int k, const string &p) : key{ k }, payload{ p } {}
+    Tracked(const Tracked &other) : key{ other.key }, payload{ other.payload } { ++copies; }
+    Tracked(Tracked &&other) noexcept = default;
+    Tracked &operator=(const Tracked &other) {
+        key = other.key;
+        payload = other.payload;
+        ++copies;
+        return *this;
+    }
+    Tracked &operator=(Tracked &&other) noexcept = default;
+};
+int Tracked::copies = 0;
+
+struct TrackedComp {
+    bool operator()(const Tracked &a, const Tracked &b) const {
+        return a.key < b.key;
+    }
+};
+
+struct TrackedKey {
+    int operator()(const Tracked &a) const {
+        return a.key;
+    }
+};
+
+// push(TYPE &&), emplace() and popK() must never copy the element.
+template<typename PQ>
+void testMovesHelper(PQ &pq) {
+    Tracked::copies = 0;
+    for (int i = 0; i < 100; ++i) {
+        Tracked element{ i * 37 % 100, "a payload long enough to be on the heap" };
+        pq.push(std::move(element));
+        pq.emplace(i * 37 % 100 + 100, "emplaced");
+    }
+    assert(pq.size() == 200);
+    for (int expected = 199; expected >= 20; --expected) {
+        assert(pq.top().key == expected);
+        pq.pop();
+    }
+    vector<Tracked> last;
+    pq.popK(20, back_inserter(last));
+    assert(pq.empty() && last.size() == 20);
+    for (int i = 0; i < 20; ++i)
+        assert(last[static_cast<size_t>(i)].key == 19 - i);
+    assert(Tracked::copies == 0);
+} // testMovesHelper()
+
+void testMoves(const string &pqType) {
+    cout << "Testing push(TYPE &&) and emplace() on " << pqType << endl;
+    if (pqType == "Unordered") {
+        UnorderedPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "Sorted") {
+        SortedPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "Binary") {
+        BinaryPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "UnorderedFast") {
+        UnorderedFastPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "Dary") {
+        DaryPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "ChunkedSorted") {
+        ChunkedSortedPQ<Tracked, TrackedComp, 8> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "IndexedBinary") {
+        IndexedBinaryPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "MinMax") {
+        MinMaxPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "Bucket") {
+        BucketPQ<Tracked, TrackedComp, TrackedKey> pq;
+        testMovesHelper(pq);
+        pq.setMode(decltype(pq)::BucketMode::Calendar);
+        testMovesHelper(pq);
+    } else if (pqType == "WeakHeap") {
+        WeakHeapPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else if (pqType == "RankPairing") {
+        RankPairingPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    } else {
+        PairingPQ<Tracked, TrackedComp> pq;
+        testMovesHelper(pq);
+    }
+    cout << "testMoves() succeeded" << endl;
+} // testMoves()
+
+
+// Push a shuffled sequence (with duplicates) and check that it pops in order.
+template<typename PQ>
+void testPopsInOrder(PQ &pq) {
+    for (int i = 0; i < 1000; ++i)
+        pq.push(i * 7919 % 500);
+    assert(pq.size() == 1000);
+    for (int expected = 499; expected >= 0; --expected) {
+        assert(pq.top() == expected);
+        pq.pop();
+        assert(pq.top() == expected);
+        pq.pop();
+    }
+    assert(pq.empty());
+} // testPopsInOrder()
+
+// Both pop modes, with an expensive-to-compare element type.
+void testBinaryPopModes() {
+    cout << "Testing binary heap pop modes" << endl;
+    BinaryPQ<int> top_down;
+    BinaryPQ<int> bottom_up;
+    bottom_up.setPopMode(BinaryPQ<int>::PopMode::BottomUp);
+    testPopsInOrder(top_down);
+    testPopsInOrder(bottom_up);
+
+    BinaryPQ<Tracked, TrackedComp> tracked;
+    tracked.setPopMode(BinaryPQ<Tracked, TrackedComp>::PopMode::BottomUp);
+    testMovesHelper(tracked);
+
+    cout << "testBinaryPopModes() succeeded" << endl;
+} // testBinaryPopModes()
+
+
+// Batches of every size relative to the heap, so that flush() takes both the
+// fix_up path and the partial heapify, including one into an empty heap.
+void testBinaryPushRange() {
+    cout << "Testing binary heap pushRange" << endl;
+    BinaryPQ<int> pq;
+    pq.reserve(5000);
+    vector<int> expected;
+    unsigned x = 281;
+    for (size_t batch : { 1000, 1, 3, 20, 700, 2, 2500 }) {
+        vector<int> vec;
+        for (size_t i = 0; i < batch; ++i) {
+            x = x * 1103515245u + 12345u;
+            vec.push_back(static_cast<int>((x >> 16) % 3000));
+        }
+        if (batch % 2 == 0) {
+            pq.pushRange(vec.begin(), vec.end());
+        } else {
+            for (int value : vec)
+                pq.push(value);
+        }
+        expected.insert(expected.end(), vec.begin(), vec.end());
+        sort(expected.begin(), expected.end());
+        assert(pq.size() == expected.size());
+
+        // Pop a few so that later batches go into a heap that is not full.
+        for (size_t i = 0; i < batch / 3; ++i) {
+            assert(pq.top() == expected.back());
+            pq.pop();
+            expected.pop_back();
+        }
+    }
+    while (!pq.empty()) {
+        assert(pq.top() == expected.back());
+        pq.pop();
+        expected.pop_back();
+    }
+    assert(expected.empty());
+
+    cout << "testBinaryPushRange() succeeded" << endl;
+} // testBinaryPushRange()
+
+
+// Compare findExtremeIndex() with the scalar loop on one array, at every
+// SIMD level the CPU has.
+template<typename TYPE, typename COMP>
+void checkFindExtreme(const vector<TYPE> &vec) {
+    COMP compare;
+    size_t expected = findExtremeScalar(vec.data(), vec.size(), compare);
+    int best_level = findExtremeSimdLevel();
+    for (int level = best_level; level >= 0; --level) {
+        findExtremeSimdLevel() = level;
+        assert(findExtremeIndex(vec.data(), vec.size(), compare) == expected);
+    }
+    findExtremeSimdLevel() = best_level;
+} // checkFindExtreme()
+
+template<typename TYPE>
+void checkFindExtremeBothWays(const vector<TYPE> &vec) {
+    checkFindExtreme<TYPE, less<TYPE>>(vec);
+    checkFindExtreme<TYPE, greater<TYPE>>(vec);
+} // checkFindExtremeBothWays()
+
+// Small value ranges give lots of ties; odd sizes leave a scalar tail.
+void testFindExtreme() {
+    cout << "Testing SIMD findExtreme" << endl;
+    for (size_t n : { 1, 31, 32, 33, 100, 1001 }) {
+        for (unsigned seed = 1; seed < 20; ++seed) {
+            vector<int32_t> ints;
+            vector<uint32_t> uints;
+            vector<float> floats;
+            vector<double> doubles;
+            for (size_t i = 0; i < n; ++i) {
+                unsigned x = static_cast<unsigned>(i) * 2654435761u + seed * 40503u;
+                ints.push_back(static_cast<int32_t>(x % 61) - 30);
+                uints.push_back(x % 7 == 0 ? 4000000000u : x % 53);
+                floats.push_back(static_cast<float>(x % 41) - 20.0f);
+                doubles.push_back(static_cast<double>(x % 43) / 3.0 - 7.0);
+            }
+            checkFindExtremeBothWays(ints);
+            checkFindExtremeBothWays(uints);
+            checkFindExtremeBothWays(floats);
+            checkFindExtremeBothWays(doubles);
+
+            // NaN somewhere in the middle, then NaN first; signed zeros.
+            float nan = numeric_limits<float>::quiet_NaN();
+            floats[n / 2] = nan;
+            checkFindExtremeBothWays(floats);
+            floats[0] = nan;
+            checkFindExtremeBothWays(floats);
+            for (size_t i = 0; i < n; ++i)
+                doubles[i] = i % 3 == 0 ? -0.0 : i % 3 == 1 ? 0.0 : -1.0;
+            checkFindExtremeBothWays(doubles);
+        }
+    }
+
+    UnorderedPQ<double, greater<double>> pq;
+    for (int i = 0; i < 1000; ++i)
+        pq.push(i * 7919 % 1000 / 10.0);
+    for (int i = 0; i < 1000; ++i) {
+        assert(pq.top() == i / 10.0);
+        pq.pop();
+    }
+
+    cout << "testFindExtreme() succeeded" << endl;
+} // testFindExtreme()
+
+
+// Several arities, including the range constructor and a partial last
+// group of children.
+void testDary() {
+    cout << "Testing d-ary heaps" << endl;
+    DaryPQ<int, less<int>, 2> binary;
+    DaryPQ<int, less<int>, 3> ternary;
+    DaryPQ<int, greater<int>, 8> octary_min;
+    testPopsInOrder(binary);
+    testPopsInOrder(ternary);
+
+    for (int i = 0; i < 1000; ++i)
+        octary_min.push(i * 7919 % 1000);
+    for (int expected = 0; expected < 1000; ++expected) {
+        assert(octary_min.top() == expected);
+        octary_min.pop();
+    }
+
+    vector<int> vec;
+    for (int i = 0; i < 37; ++i)
+        vec.push_back(i * 11 % 37);
+    DaryPQ<int, less<int>, 8> from_range(vec.begin(), vec.end());
+    for (int expected = 36; expected >= 0; --expected) {
+        assert(from_range.top() == expected);
+        from_range.pop();
+    }
+
+    cout << "testDary() succeeded" << endl;
+} // testDary()
+
+
+// Ties are broken by index, so with and without the block index the same
+// element should come out at every step, through growth, shrinking, and
+// interleaved pushes.
+void testUnorderedFastBlocks() {
+    cout << "Testing UnorderedFastPQ block index" << endl;
+    using Keyed = pair<int, int>;
+    struct KeyOnly {
+        bool operator()(const Keyed &a, const Keyed &b) const {
+            return a.first < b.first;
+        }
+    };
+    UnorderedFastPQ<int> blocked_ints;
+    blocked_ints.setBlockIndex(true);
+    testPopsInOrder(blocked_ints);
+
+    UnorderedFastPQ<Keyed, KeyOnly> plain;
+    UnorderedFastPQ<Keyed, KeyOnly> blocked;
+    blocked.setBlockIndex(true);
+    unsigned x = 12345;
+    int id = 0;
+    for (int round = 0; round < 6; ++round) {
+        for (int i = 0; i < 3000; ++i) {
+            x = x * 1103515245u + 12345u;
+            Keyed elt{ static_cast<int>((x >> 16) % 50), id++ };
+            plain.push(elt);
+            blocked.push(elt);
+            if (x % 5 == 0) {
+                assert(plain.top() == blocked.top());
+            }
+            if (x % 3 == 0) {
+                plain.pop();
+                blocked.pop();
+            }
+        }
+        if (round == 2)
+            blocked.setBlockIndex(false);
+        if (round == 3)
+            blocked.setBlockIndex(true);
+        while (plain.size() > (round % 2 == 0 ? 10u : 1500u)) {
+            assert(plain.top() == blocked.top());
+            plain.pop();
+            blocked.pop();
+        }
+        assert(plain.size() == blocked.size());
+    }
+    while (!plain.empty()) {
+        assert(plain.top() == blocked.top());
+        plain.pop();
+        blocked.pop();
+    }
+    assert(blocked.empty());
+
+    cout << "testUnorderedFastBlocks() succeeded" << endl;
+} // testUnorderedFastBlocks()
+
+
+// pushRange() into empty and non-empty queues, then a partial re-sort of
+// pointers whose targets changed.
+void testSortedBulk() {
+    cout << "Testing sorted PQ pushRange and partial updatePriorities" << endl;
+    SortedPQ<int> pq;
+    vector<int> expected;
+    for (int batch = 0; batch < 5; ++batch) {
+        vector<int> vec;
+        for (int i = 0; i < 200; ++i)
+            vec.push_back((i * 7919 + batch * 31) % 450);
+        pq.pushRange(vec.begin(), vec.end());
+        expected.insert(expected.end(), vec.begin(), vec.end());
+    }
+    sort(expected.begin(), expected.end());
+    while (!pq.empty()) {
+        assert(pq.top() == expected.back());
+        pq.pop();
+        expected.pop_back();
+    }
+
+    // Element i of 'values' is i, so it sits at index i in sorted order.
+    vector<int> values(1000);
+    vector<int *> pointers;
+    for (int i = 0; i < 1000; ++i) {
+        values[static_cast<size_t>(i)] = i;
+        pointers.push_back(&values[static_cast<size_t>(i)]);
+    }
+    SortedPQ<int *, IntPtrComp> pointed(pointers.begin(), pointers.end());
+    vector<size_t> dirty;
+    for (size_t i = 3; i < values.size(); i += 17) {
+        values[i] = static_cast<int>(i * 7 % 1100) - 50;
+        dirty.push_back(i);
+    }
+    dirty.push_back(3);
+    pointed.updatePriorities(dirty);
+    vector<int> sorted_values = values;
+    sort(sorted_values.begin(), sorted_values.end());
+    while (!pointed.empty()) {
+        assert(*pointed.top() == sorted_values.back());
+        pointed.pop();
+        sorted_values.pop_back();
+    }
+
+    cout << "testSortedBulk() succeeded" << endl;
+} // testSortedBulk()
+
+
+// Small chunks, so that pushes split chunks all over the place and pops
+// empty them, checked against SortedPQ.
+void testChunkedSorted() {
+    cout << "Testing chunked sorted PQ" << endl;
+    ChunkedSortedPQ<int, less<int>, 4> tiny;
+    testPopsInOrder(tiny);
+
+    ChunkedSortedPQ<int, greater<int>, 16> chunked;
+    SortedPQ<int, greater<int>> sorted;
+    unsigned x = 4242;
+    for (int i = 0; i < 20000; ++i) {
+        x = x * 1103515245u + 12345u;
+        int value = static_cast<int>((x >> 16) % 1000);
+        chunked.push(value);
+        sorted.push(value);
+        if (x % 4 == 0) {
+            assert(chunked.top() == sorted.top());
+            chunked.pop();
+            sorted.pop();
+        }
+    }
+    assert(chunked.size() == sorted.size());
+    // begin() to end() walks the chunks in the same order as SortedPQ.
+    assert(equal(chunked.begin(), chunked.end(), sorted.begin(), sorted.end()));
+    assert(static_cast<size_t>(chunked.end() - chunked.begin()) == chunked.size());
+
+    vector<int> vec;
+    for (int i = 0; i < 100; ++i)
+        vec.push_back(i * 37 % 100);
+    ChunkedSortedPQ<int, less<int>, 8> from_range(vec.begin(), vec.end());
+    from_range.updatePriorities();
+    for (int expected = 99; expected >= 0; --expected) {
+        assert(from_range.top() == expected);
+        from_range.pop();
+    }
+    assert(from_range.empty());
+
+    while (!sorted.empty()) {
+        assert(chunked.top() == sorted.top());
+        chunked.pop();
+        sorted.pop();
+    }
+    assert(chunked.empty());
+
+    cout << "testChunkedSorted() succeeded" << endl;
+} // testChunkedSorted()
+
+
+// Rebuild with several threads, including a thread count that does not
+// divide the work evenly, and check the pops against a sorted copy.
+template<typename PQ>
+void testParallelRebuild(const string &pqType) {
+    cout << "Testing parallel rebuild of " << pqType << endl;
+    vector<int> vec;
+    unsigned x = 99;
+    for (size_t i = 0; i < 3 * PQ_PARALLEL_MIN + 7; ++i) {
+        x = x * 1103515245u + 12345u;
+        vec.push_back(static_cast<int>((x >> 8) % 100000));
+    }
+    vector<int> expected = vec;
+    sort(expected.begin(), expected.end());
+
+    for (unsigned threads : { 2u, 3u, 8u }) {
+        pqThreadCount() = threads;
+        PQ pq(vec.begin(), vec.end());
+        pq.updatePriorities();
+        for (size_t i = expected.size(); i != 0; --i) {
+            assert(pq.top() == expected[i - 1]);
+            pq.pop();
+        }
+    }
+    pqThreadCount() = 1;
+
+    cout << "testParallelRebuild() succeeded" << endl;
+} // testParallelRebuild()
+
+
+// An exception from the calling thread's piece reaches the caller only
+// after the other threads have finished theirs.
+void testParallelForThrow() {
+    cout << "Testing parallelFor() with a throwing piece" << endl;
+    atomic<size_t> done{ 0 };
+    bool caught = false;
+    try {
+        parallelFor(8, 4, [&done](size_t first, size_t last) {
+            if (first == 0)
+                throw runtime_error("piece 0");
+            done += last - first;
+        });
+    } catch (const runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+    assert(done == 6);
+    cout << "testParallelForThrow() succeeded" << endl;
+} // testParallelForThrow()
+
+
+// Change a few (repaired) or many (rebuilt) of the pointed-to values each
+// round, and check top() against the largest value still in the PQ.  All of
+// a round's elements are marked with 'mark(pq, index, live)' before any of
+// them change, and values stay distinct, so positions in sorted order are
+// well defined.
+template<typename PQ, typename Push, typename Mark>
+void testMarkDirtyHelper(PQ &pq, Push push, Mark mark, vector<int> &values) {
+    vector<bool> live(values.size(), true);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(i * 7919 % 10007) * 2;
+    for (size_t i = 0; i < values.size(); ++i)
+        push(pq, i);
+    int counter = 0;
+    for (size_t changes : { 1, 3, 10, 1500, 2, 40, 700, 5, 5, 5 }) {
+        // The first live index at or after a pseudo-random start, each time.
+        vector<size_t> changed;
+        for (size_t c = 0; c < changes && c < pq.size(); ++c) {
+            size_t j = (static_cast<size_t>(counter) + c) * 2654435761u % values.size();
+            while (!live[j])
+                j = (j + 1) % values.size();
+            mark(pq, j, live);
+            changed.push_back(j);
+        }
+        for (size_t j : changed)
+            values[j] = (++counter * 7919 % 100003) * 2 + 1;
+        pq.updatePriorities();
+        for (int pops = 0; pops < 50 && !pq.empty(); ++pops) {
+            int largest = numeric_limits<int>::min();
+            for (size_t i = 0; i < values.size(); ++i)
+                if (live[i])
+                    largest = max(largest, values[i]);
+            assert(*pq.top() == largest);
+            live[static_cast<size_t>(pq.top() - values.data())] = false;
+            pq.pop();
+        }
+    }
+} // testMarkDirtyHelper()
+
+// Pop everything and check that the pointed-to values never increase.
+template<typename PQ>
+void testPointeesInOrder(PQ &pq) {
+    int previous = numeric_limits<int>::max();
+    while (!pq.empty()) {
+        assert(*pq.top() <= previous);
+        previous = *pq.top();
+        pq.pop();
+    }
+} // testPointeesInOrder()
+
+// For PQs whose begin()/end() give markDirty() positions.
+template<typename PQ>
+void testMarkDirtyByPosition(PQ &pq) {
+    vector<int> values(2000);
+    auto push = [&values](PQ &q, size_t i) { q.push(&values[i]); };
+    auto mark = [&values](PQ &q, size_t j, const vector<bool> &) {
+        auto it = find(q.begin(), q.end(), &values[j]);
+        assert(it != q.end());
+        q.markDirty(static_cast<size_t>(it - q.begin()));
+    };
+    testMarkDirtyHelper(pq, push, mark, values);
+
+    // A mark left past the end by later pops is skipped.
+    PQ stale;
+    for (size_t i = 0; i < 1000; ++i)
+        stale.push(&values[i]);
+    stale.markDirty(stale.size() - 1);
+    stale.pop();
+    stale.pop();
+    stale.updatePriorities();
+    testPointeesInOrder(stale);
+} // testMarkDirtyByPosition()
+
+void testMarkDirty(const string &pqType) {
+    cout << "Testing markDirty() on " << pqType << endl;
+    vector<int> values(2000);
+    if (pqType == "Unordered") {
+        UnorderedPQ<int *, IntPtrComp> pq;
+        testMarkDirtyByPosition(pq);
+    } else if (pqType == "Sorted") {
+        SortedPQ<int *, IntPtrComp> pq;
+        testMarkDirtyByPosition(pq);
+    } else if (pqType == "Binary") {
+        BinaryPQ<int *, IntPtrComp> pq;
+        testMarkDirtyByPosition(pq);
+    } else if (pqType == "UnorderedFast") {
+        UnorderedFastPQ<int *, IntPtrComp> pq;
+        testMarkDirtyByPosition(pq);
+        UnorderedFastPQ<int *, IntPtrComp> blocked;
+        blocked.setBlockIndex(true);
+        testMarkDirtyByPosition(blocked);
+    } else if (pqType == "Dary") {
+        DaryPQ<int *, IntPtrComp, 3> pq;
+        testMarkDirtyByPosition(pq);
+    } else if (pqType == "ChunkedSorted") {
+        ChunkedSortedPQ<int *, IntPtrComp, 16> pq;
+        testMarkDirtyByPosition(pq);
+    } else if (pqType == "MinMax") {
+        MinMaxPQ<int *, IntPtrComp> pq;
+        testMarkDirtyByPosition(pq);
+    } else if (pqType == "Bucket") {
+        // BucketPQ has no markDirty(): updatePriorities() always moves every
+        // element, which this still checks in both modes.
+        using PQ = BucketPQ<int *, IntPtrComp, IntPtrKey>;
+        for (PQ::BucketMode mode : { PQ::BucketMode::Fixed, PQ::BucketMode::Calendar }) {
+            PQ pq;
+            pq.setMode(mode);
+            auto push = [&values](PQ &q, size_t i) { q.push(&values[i]); };
+            auto mark = [](PQ &, size_t, const vector<bool> &) {};
+            testMarkDirtyHelper(pq, push, mark, values);
+        }
+    } else if (pqType == "WeakHeap") {
+        // No markDirty() here either: updatePriorities() rebuilds the whole
+        // heap with n - 1 comparisons.
+        using PQ = WeakHeapPQ<int *, IntPtrComp>;
+        PQ pq;
+        auto push = [&values](PQ &q, size_t i) { q.push(&values[i]); };
+        auto mark = [](PQ &, size_t, const vector<bool> &) {};
+        testMarkDirtyHelper(pq, push, mark, values);
+    } else if (pqType == "RankPairing") {
+        using PQ = RankPairingPQ<int *, IntPtrComp>;
+        PQ pq;
+        vector<PQ::Node *> handles(values.size());
+        auto push = [&values, &handles](PQ &q, size_t i) { handles[i] = q.addNode(&values[i]); };
+        auto mark = [&handles](PQ &q, size_t j, const vector<bool> &) {
+            q.markDirty(handles[j]);
+        };
+        testMarkDirtyHelper(pq, push, mark, values);
+
+        // Lower the top and raise another root in one batch: the raised root
+        // must not win against the top's new value alone and hide the 6.
+        int small[] = { 1, 1, 7, 6 };
+        PQ roots;
+        vector<PQ::Node *> nodes;
+        for (int &value : small)
+            nodes.push_back(roots.addNode(&value));
+        small[2] = 1;
+        small[1] = 4;
+        roots.markDirty(nodes[2]);
+        roots.markDirty(nodes[1]);
+        roots.updatePriorities();
+        for (int expected : { 6, 4, 1, 1 }) {
+            assert(*roots.top() == expected);
+            roots.pop();
+        }
+    } else if (pqType == "IndexedBinary") {
+        using PQ = IndexedBinaryPQ<int *, IntPtrComp>;
+        PQ pq;
+        vector<PQ::Handle> handles(values.size());
+        auto push = [&values, &handles](PQ &q, size_t i) { handles[i] = q.addElt(&values[i]); };
+        auto mark = [&handles](PQ &q, size_t j, const vector<bool> &) {
+            q.markDirty(handles[j]);
+        };
+        testMarkDirtyHelper(pq, push, mark, values);
+
+        // A handle popped after it was marked is skipped.
+        PQ stale;
+        for (size_t i = 0; i < 1000; ++i)
+            handles[i] = stale.addElt(&values[i]);
+        size_t best = 0;
+        for (size_t i = 1; i < 1000; ++i)
+            if (values[i] > values[best])
+                best = i;
+        stale.markDirty(handles[best]);
+        stale.pop();
+        stale.updatePriorities();
+        testPointeesInOrder(stale);
+    } else {
+        using PQ = PairingPQ<int *, IntPtrComp>;
+        PQ pq;
+        vector<PQ::Node *> handles(values.size());
+        auto push = [&values, &handles](PQ &q, size_t i) { handles[i] = q.addNode(&values[i]); };
+        auto mark = [&handles](PQ &q, size_t j, const vector<bool> &) {
+            q.markDirty(handles[j]);
+        };
+        testMarkDirtyHelper(pq, push, mark, values);
+    }
+    cout << "testMarkDirty() succeeded" << endl;
+} // testMarkDirty()
+
+
+// Random pushes and pops from both ends against a sorted reference, then a
+// bounded stream: only the best 'capacity' elements may be left, and
+// pushBounded() must report whether it kept each one.
+void testMinMax() {
+    cout << "Testing MinMaxPQ" << endl;
+    MinMaxPQ<int> pq;
+    vector<int> reference;
+    unsigned x = 7;
+    for (int op = 0; op < 20000; ++op) {
+        x = x * 1103515245u + 12345u;
+        unsigned choice = (x >> 16) % 8;
+        if (choice < 4 || reference.empty()) {
+            int value = static_cast<int>((x >> 4) % 1000);
+            pq.push(value);
+            reference.insert(upper_bound(reference.begin(), reference.end(), value), value);
+        } else if (choice < 6) {
+            assert(pq.top() == reference.back());
+            pq.popMax();
+            reference.pop_back();
+        } else {
+            assert(pq.bottom() == reference.front());
+            pq.popMin();
+            reference.erase(reference.begin());
+        }
+        assert(pq.size() == reference.size());
+        if (!pq.empty())
+            assert(pq.top() == reference.back() && pq.bottom() == reference.front());
+    }
+
+    // Shrinking drops the least extreme elements.
+    pq.setCapacity(10);
+    assert(pq.size() == min<size_t>(10, reference.size()));
+    assert(pq.bottom() == reference[reference.size() - pq.size()]);
+
+    for (size_t capacity : { 0, 1, 2, 3, 100 }) {
+        MinMaxPQ<int> bounded;
+        bounded.setCapacity(capacity);
+        vector<int> stream;
+        for (int i = 0; i < 5000; ++i) {
+            int value = (i * 7919) % 2003;
+            bool full = bounded.size() == capacity;
+            int worst = full && capacity != 0 ? bounded.bottom() : 0;
+            bool kept = bounded.pushBounded(value);
+            assert(kept == (!full || (capacity != 0 && worst < value)));
+            assert(bounded.size() <= capacity);
+            stream.push_back(value);
+        }
+        sort(stream.begin(), stream.end());
+        vector<int> best;
+        bounded.popK(capacity, back_inserter(best));
+        assert(best.size() == capacity);
+        for (size_t i = 0; i < best.size(); ++i)
+            assert(best[i] == stream[stream.size() - 1 - i]);
+    }
+
+    vector<int> vec{ 5, 1, 9, 3, 7, 2, 8, 6, 4, 0 };
+    MinMaxPQ<int> ranged(vec.begin(), vec.end());
+    for (int expected = 0; expected < 5; ++expected) {
+        assert(ranged.bottom() == expected && ranged.top() == 9 - expected);
+        ranged.popMin();
+        ranged.popMax();
+    }
+    assert(ranged.empty());
+
+    cout << "testMinMax() succeeded" << endl;
+} // testMinMax()
+
+
+// Monotone use of a RadixPQ, as Dijkstra would: every push is at least the
+// last key popped.  Checked against a sorted reference for one key type.
+template<typename KEY, typename Next>
+void testRadixMonotone(KEY start, Next next) {
+    RadixPQ<pair<KEY, int>> pq;
+    vector<KEY> reference;
+    KEY floor = start;
+    unsigned x = 5;
+    for (int op = 0; op < 20000; ++op) {
+        x = x * 1103515245u + 12345u;
+        if ((x >> 16) % 3 != 0 || reference.empty()) {
+            KEY key = next(floor, x >> 4);
+            pq.push({ key, op });
+            reference.insert(upper_bound(reference.begin(), reference.end(), key), key);
+        } else {
+            assert(pq.top().first == reference.front());
+            floor = reference.front();
+            pq.pop();
+            reference.erase(reference.begin());
+        }
+        assert(pq.size() == reference.size());
+    }
+    vector<pair<KEY, int>> rest;
+    pq.popK(reference.size(), back_inserter(rest));
+    assert(pq.empty() && rest.size() == reference.size());
+    for (size_t i = 0; i < rest.size(); ++i)
+        assert(rest[i].first == reference[i]);
+} // testRadixMonotone()
+
+// RadixPQ keyed through a pointer, so that updatePriorities() sees keys
+// change in both directions.
+struct UnsignedPtrKey {
+    unsigned operator()(const unsigned *p) const {
+        return *p;
+    }
+};
+
+void testRadix() {
+    cout << "Testing RadixPQ" << endl;
+    testRadixMonotone<uint32_t>(0, [](uint32_t floor, unsigned r) { return floor + r % 1000; });
+    testRadixMonotone<uint64_t>(uint64_t{ 1 } << 40,
+        [](uint64_t floor, unsigned r) { return floor + (uint64_t{ r } << (r % 16)); });
+    testRadixMonotone<float>(-1000.0f,
+        [](float floor, unsigned r) { return floor + static_cast<float>(r % 4096) / 16.0f; });
+    testRadixMonotone<double>(-1e9,
+        [](double floor, unsigned r) { return floor + static_cast<double>(r % 100000) * 0.37; });
+
+    // The range constructor takes keys in any order, and payloads move.
+    vector<pair<uint32_t, string>> items{ { 9, "nine" }, { 3, "three" }, { 7, "seven" },
+                                          { 3, "also three" }, { 0, "zero" } };
+    RadixPQ<pair<uint32_t, string>> ranged(items.begin(), items.end());
+    assert(ranged.size() == 5 && ranged.top().second == "zero");
+    ranged.pop();
+    assert(ranged.top().first == 3);
+    ranged.pop();
+    assert(ranged.top().first == 3);
+    ranged.pop();
+    ranged.emplace(8u, "eight");
+    assert(ranged.top().second == "seven");
+    ranged.pop();
+    assert(ranged.top().second == "eight");
+
+    vector<unsigned> values{ 50, 10, 40, 30, 20 };
+    RadixPQ<const unsigned *, UnsignedPtrKey> pq;
+    for (const unsigned &value : values)
+        pq.push(&value);
+    assert(*pq.top() == 10);
+    values[1] = 60;
+    values[4] = 5;
+    pq.updatePriorities();
+    for (unsigned expected : { 5, 30, 40, 50, 60 }) {
+        assert(*pq.top() == expected);
+        pq.pop();
+    }
+
+    cout << "testRadix() succeeded" << endl;
+} // testRadix()
+
+
+// Random pushes and pops against a reference sorted by key and then by
+// arrival, so that equal keys must come out first in, first out.  'next'
+// makes the key for each push from the last key popped, which lets the
+// calendar test advance through time like an event queue.
+template<typename Key, typename COMP, typename Next>
+void testBucketOrder(BucketPQ<pair<Key, int>, COMP> &pq, Next next) {
+    vector<pair<Key, int>> reference;
+    // Sorted so that the next element to pop is at the back.
+    auto order = [](const pair<Key, int> &a, const pair<Key, int> &b) {
+        if (a.first != b.first)
+            return BucketSmallestFirst<COMP>::value ? a.first > b.first : a.first < b.first;
+        return a.second > b.second;
+    };
+    Key now = next(Key{}, 0u);
+    unsigned x = 11;
+    for (int op = 0; op < 20000; ++op) {
+        x = x * 1103515245u + 12345u;
+        if ((x >> 16) % 5 < 3 || reference.empty()) {
+            Key key = next(now, x >> 4);
+            pq.push({ key, op });
+            reference.insert(upper_bound(reference.begin(), reference.end(), make_pair(key, op), order),
+                             make_pair(key, op));
+        } else {
+            assert(pq.top() == reference.back());
+            now = reference.back().first;
+            pq.pop();
+            reference.pop_back();
+        }
+        assert(pq.size() == reference.size());
+    }
+} // testBucketOrder()
+
+// Keys are pair::first; the payload is only there to check FIFO order.
+template<typename Key, typename COMP>
+using KeyedPQ = BucketPQ<pair<Key, int>, COMP>;
+
+void testBucket() {
+    cout << "Testing BucketPQ" << endl;
+    using Smallest = greater<pair<unsigned, int>>;
+    using Largest = less<pair<int, int>>;
+    using Times = greater<pair<uint64_t, int>>;
+
+    // 256 QoS classes, lowest first.
+    KeyedPQ<unsigned, Smallest> qos;
+    testBucketOrder(qos, [](unsigned, unsigned r) { return r % 256; });
+    assert(qos.bucketWidth() == 1);
+
+    // Signed keys, largest first, with a range that moves.
+    KeyedPQ<int, Largest> signedKeys;
+    testBucketOrder(signedKeys, [](int now, unsigned r) { return now + static_cast<int>(r % 2001) - 1000; });
+
+    // Event times spread far apart: Calendar mode must widen its buckets, and
+    // Fixed mode must fall back to wide buckets rather than 2^40 of them.
+    for (bool calendar : { true, false }) {
+        KeyedPQ<uint64_t, Times> events;
+        if (calendar)
+            events.setMode(KeyedPQ<uint64_t, Times>::BucketMode::Calendar);
+        testBucketOrder(events, [](uint64_t now, unsigned r) {
+            return now + (uint64_t{ r % 8 } << (r % 27));
+        });
+        assert(events.bucketWidth() > 1);
+        events.push({ uint64_t{ 1 } << 40, -1 });
+        events.push({ 0, -2 });
+        assert(events.top().second == -2);
+    }
+
+    // A few keys billions apart must not take a bucket per key in Fixed mode,
+    // and the buckets narrow again once enough elements fill a small range.
+    BucketPQ<int> sparse;
+    for (int k : { 0, 100000000, -100000000, 2000000000 })
+        sparse.push(k);
+    assert(sparse.bucketWidth() >= (uint64_t{ 1 } << 21));
+    for (int k : { 2000000000, 100000000, 0, -100000000 }) {
+        assert(sparse.top() == k);
+        sparse.pop();
+    }
+    for (int i = 0; i < 5000; ++i)
+        sparse.push(i * 7919 % 1000);
+    assert(sparse.bucketWidth() == 1);
+    for (int i = 999; i >= 0; --i) {
+        for (int copies = 0; copies < 5; ++copies) {
+            assert(sparse.top() == i);
+            sparse.pop();
+        }
+    }
+
+    // Wide calendar buckets keep their keys sorted, and equal keys FIFO, when
+    // keys arrive out of order.
+    KeyedPQ<uint64_t, Times> wide;
+    wide.setMode(KeyedPQ<uint64_t, Times>::BucketMode::Calendar);
+    wide.push({ uint64_t{ 1 } << 30, -1 });
+    for (int i = 0; i < 1000; ++i)
+        wide.push({ static_cast<uint64_t>(i * 37 % 50), i });
+    assert(wide.bucketWidth() > 50);
+    pair<uint64_t, int> last{ 0, -1 };
+    for (int i = 0; i < 1000; ++i) {
+        assert(wide.top().first > last.first || (wide.top().first == last.first && wide.top().second > last.second));
+        last = wide.top();
+        wide.pop();
+    }
+    assert(wide.top().second == -1);
+
+    // Switching modes keeps the elements and their order.
+    KeyedPQ<unsigned, Smallest> switching;
+    for (int i = 0; i < 1000; ++i)
+        switching.push({ static_cast<unsigned>(i * 7919 % 100), i });
+    switching.setMode(KeyedPQ<unsigned, Smallest>::BucketMode::Calendar);
+    switching.setMode(KeyedPQ<unsigned, Smallest>::BucketMode::Fixed);
+    pair<unsigned, int> previous{ 0, -1 };
+    while (!switching.empty()) {
+        pair<unsigned, int> next = switching.top();
+        assert(next.first > previous.first || (next.first == previous.first && next.second > previous.second));
+        previous = next;
+        switching.pop();
+    }
+
+    cout << "testBucket() succeeded" << endl;
+} // testBucket()
+
+
+// Counts the comparisons a WeakHeapPQ makes, which it bounds exactly.
+struct CountingIntPtrComp {
+    size_t *calls;
+    bool operator()(const int *a, const int *b) const {
+        ++*calls;
+        return *a < *b;
+    }
+};
+
+// Random pushes and pops against a sorted reference, checking the comparison
+// bounds: n - 1 to build, at most ceil(log2(n)) per pop.
+void testWeakHeap() {
+    cout << "Testing WeakHeapPQ" << endl;
+    vector<int> values;
+    unsigned x = 5;
+    for (int i = 0; i < 5000; ++i) {
+        x = x * 1103515245u + 12345u;
+        values.push_back(static_cast<int>((x >> 8) % 3000));
+    }
+    vector<int *> pointers;
+    for (int &value : values)
+        pointers.push_back(&value);
+
+    auto ceilLog2 = [](size_t n) {
+        size_t bits = 0;
+        while ((size_t{ 1 } << bits) < n)
+            ++bits;
+        return bits;
+    };
+    size_t calls = 0;
+    WeakHeapPQ<int *, CountingIntPtrComp> pq(pointers.begin(), pointers.end(), CountingIntPtrComp{ &calls });
+    assert(calls == values.size() - 1);
+    vector<int> reference = values;
+    sort(reference.begin(), reference.end());
+
+    for (int op = 0; op < 20000; ++op) {
+        x = x * 1103515245u + 12345u;
+        if ((x >> 16) % 2 == 0 || reference.empty()) {
+            int *value = pointers[(x >> 4) % pointers.size()];
+            pq.push(value);
+            reference.insert(upper_bound(reference.begin(), reference.end(), *value), *value);
+        } else {
+            assert(*pq.top() == reference.back());
+            size_t before = calls;
+            pq.pop();
+            assert(calls - before <= ceilLog2(reference.size()));
+            reference.pop_back();
+        }
+        assert(pq.size() == reference.size());
+    }
+    while (!pq.empty()) {
+        assert(*pq.top() == reference.back());
+        pq.pop();
+        reference.pop_back();
+    }
+
+    // Rebuilding in place after the keys change, also with n - 1 comparisons.
+    WeakHeapPQ<int *, CountingIntPtrComp> rebuilt(CountingIntPtrComp{ &calls });
+    for (int *pointer : pointers)
+        rebuilt.push(pointer);
+    for (int &value : values)
+        value = 3000 - value;
+    calls = 0;
+    rebuilt.updatePriorities();
+    assert(calls == values.size() - 1);
+    reference = values;
+    sort(reference.begin(), reference.end());
+    while (!rebuilt.empty()) {
+        assert(*rebuilt.top() == reference.back());
+        rebuilt.pop();
+        reference.pop_back();
+    }
+
+    cout << "testWeakHeap() succeeded" << endl;
+} // testWeakHeap()
+
+
+// Take batches of several sizes, through the PQ's own popK() and through the
+// base class, with pushes in between, and check each batch (and the pops
+// after it) against a sorted reference.  Values repeat, and the large
+// batches (4k >= n) exercise BinaryPQ's selection-and-heapify path.
+template<typename PQ>
+void testPopKHelper(PQ &pq) {
+    vector<int> reference;
+    auto pushSome = [&pq, &reference](int count, int seed) {
+        for (int i = 0; i < count; ++i) {
+            int value = (i + seed) * 7919 % 500;
+            pq.push(value);
+            reference.push_back(value);
+        }
+        sort(reference.begin(), reference.end());
+    };
+    pushSome(1000, 0);
+    bool viaBase = false;
+    for (size_t k : { 0, 1, 7, 300, 2, 100, 450, 5000 }) {
+        vector<int> batch;
+        if (viaBase) {
+            Eecs281PQ<int> &base = pq;
+            base.popK(k, back_inserter(batch));
+        } else {
+            pq.popK(k, back_inserter(batch));
+        }
+        viaBase = !viaBase;
+        assert(batch.size() == min(k, batch.size() + pq.size()));
+        for (int value : batch) {
+            assert(value == reference.back());
+            reference.pop_back();
+        }
+        assert(pq.size() == reference.size());
+        if (!pq.empty()) {
+            assert(pq.top() == reference.back());
+            pq.pop();
+            reference.pop_back();
+        }
+        pushSome(static_cast<int>(k % 97), static_cast<int>(k));
+    }
+} // testPopKHelper()
+
+void testPopK(const string &pqType) {
+    cout << "Testing popK() on " << pqType << endl;
+    if (pqType == "Unordered") {
+        UnorderedPQ<int> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "Sorted") {
+        SortedPQ<int> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "Binary") {
+        BinaryPQ<int> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "UnorderedFast") {
+        UnorderedFastPQ<int> pq;
+        testPopKHelper(pq);
+        UnorderedFastPQ<int> blocked;
+        blocked.setBlockIndex(true);
+        testPopKHelper(blocked);
+    } else if (pqType == "Dary") {
+        DaryPQ<int, std::less<int>, 3> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "ChunkedSorted") {
+        ChunkedSortedPQ<int, std::less<int>, 16> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "IndexedBinary") {
+        IndexedBinaryPQ<int> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "MinMax") {
+        MinMaxPQ<int> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "Bucket") {
+        BucketPQ<int> pq;
+        testPopKHelper(pq);
+        BucketPQ<int> calendar;
+        calendar.setMode(BucketPQ<int>::BucketMode::Calendar);
+        testPopKHelper(calendar);
+    } else if (pqType == "WeakHeap") {
+        WeakHeapPQ<int> pq;
+        testPopKHelper(pq);
+    } else if (pqType == "RankPairing") {
+        RankPairingPQ<int> pq;
+        testPopKHelper(pq);
+    } else {
+        PairingPQ<int> pq;
+        testPopKHelper(pq);
+    }
+    cout << "testPopK() succeeded" << endl;
+} // testPopK()
+
+
+// Random updateKey() in both directions and erase() against a reference
+// vector, checking that every handle still names its element.
+void testIndexedBinary() {
+    cout << "Testing indexed binary heap" << endl;
+    using PQ = IndexedBinaryPQ<int>;
+    PQ simple;
+    testPopsInOrder(simple);
+
+    PQ pq;
+    vector<int> expected;          // value by handle, or -1 once removed
+    unsigned x = 7;
+    auto next = [&x]() { x = x * 1103515245u + 12345u; return static_cast<int>((x >> 16) % 10000); };
+    for (int i = 0; i < 3000; ++i) {
+        PQ::Handle handle = pq.addElt(next());
+        if (handle >= expected.size())
+            expected.resize(handle + 1, -1);
+        expected[handle] = pq.getElt(handle);
+
+        PQ::Handle target = static_cast<PQ::Handle>(next()) % expected.size();
+        if (expected[target] >= 0) {
+            if (i % 3 == 0) {
+                pq.erase(target);
+                expected[target] = -1;
+                assert(!pq.contains(target));
+            } else {
+                int value = next();
+                pq.updateKey(target, value);
+                expected[target] = value;
+            }
+        }
+        if (i % 7 == 0 && !pq.empty()) {
+            int largest = *max_element(expected.begin(), expected.end());
+            assert(pq.top() == largest);
+            assert(expected[pq.topHandle()] == largest);
+            expected[pq.topHandle()] = -1;
+            pq.pop();
+        }
+    }
+    for (PQ::Handle handle = 0; handle < expected.size(); ++handle) {
+        assert(pq.contains(handle) == (expected[handle] >= 0));
+        if (expected[handle] >= 0)
+            assert(pq.getElt(handle) == expected[handle]);
+    }
+    pq.updatePriorities();
+    while (!pq.empty()) {
+        int largest = *max_element(expected.begin(), expected.end());
+        assert(pq.top() == largest);
+        expected[pq.topHandle()] = -1;
+        pq.pop();
+    }
+
+    cout << "testIndexedBinary() succeeded" << endl;
+} // testIndexedBinary()
+
+
 // Very basic testing.
 void testPriorityQueue(Eecs281PQ<int> *pq, const string &pqType) {
     cout << "Testing priority queue: " << pqType << endl;
@@ -217,6 +1409,366 @@ void test_update_pairing() {
     cout << "Testing update pairing succeeded." << endl;
 }
 
+// The tests of the Node* handle interface take the heap as a template, so
+// that RankPairingPQ, a drop-in replacement for PairingPQ, runs them too.
+
+// Test a pairing heap whose elements have destructors, so that both pop()
+// and the destructor have to give every node back to the pool properly.
+template<template<typename...> class HEAP>
+void testPairingStrings() {
+    cout << "Testing pairing heap of strings" << endl;
+    // Zero-padded so that the strings sort in numeric order.
+    auto name = [](int i) { return "element " + string(i < 10 ? "00" : i < 100 ? "0" : "") + to_string(i); };
+    HEAP<string> pq;
+    for (int i = 0; i < 1000; ++i)
+        pq.push(name(i * 7919 % 1000));
+
+    assert(pq.size() == 1000);
+    assert(pq.top() == "element 999");
+    for (int i = 0; i < 500; ++i)
+        pq.pop();
+    assert(pq.top() == "element 499");
+
+    // Refill the slots freed by pop(), then leave the rest for the destructor.
+    for (int i = 0; i < 500; ++i)
+        pq.push(name(i));
+    assert(pq.size() == 1000);
+    assert(pq.top() == "element 499");
+
+    cout << "testPairingStrings() succeeded" << endl;
+} // testPairingStrings()
+
+
+// erase() anywhere in the tree and updateElt() in both directions, checked
+// against the values still in the heap; every remaining handle must still
+// name its value.  Then demote pointed-to values in place.
+template<template<typename...> class HEAP>
+void testPairingErase() {
+    cout << "Testing pairing erase and general updateElt" << endl;
+    using PQ = HEAP<int>;
+    PQ pq;
+    vector<typename PQ::Node *> nodes;
+    vector<int> values;             // -1 once erased or popped
+    unsigned x = 11;
+    auto next = [&x]() { x = x * 1103515245u + 12345u; return static_cast<int>((x >> 16) % 5000); };
+    for (int i = 0; i < 3000; ++i) {
+        values.push_back(next());
+        nodes.push_back(pq.addNode(values.back()));
+        if (i % 5 == 4) {
+            // Pop to keep the trees deep, finding the root's handle by address.
+            for (size_t j = 0; j < nodes.size(); ++j) {
+                if (nodes[j] != nullptr && &nodes[j]->getElt() == &pq.top()) {
+                    values[j] = -1;
+                    nodes[j] = nullptr;
+                }
+            }
+            pq.pop();
+        }
+    }
+    assert(pq.size() == 2400);
+
+    for (int i = 0; i < 4000; ++i) {
+        size_t j = static_cast<size_t>(next()) * 7 % nodes.size();
+        if (nodes[j] == nullptr)
+            continue;
+        assert(nodes[j]->getElt() == values[j]);
+        if (i % 3 == 0) {
+            pq.erase(nodes[j]);
+            nodes[j] = nullptr;
+            values[j] = -1;
+        } else {
+            values[j] = i % 3 == 1 ? values[j] / 2 : next();
+            pq.updateElt(nodes[j], values[j]);
+        }
+        if (i % 50 == 0 && !pq.empty())
+            assert(pq.top() == *max_element(values.begin(), values.end()));
+    }
+    for (size_t j = 0; j < nodes.size(); ++j)
+        if (nodes[j] != nullptr)
+            assert(nodes[j]->getElt() == values[j]);
+    while (!pq.empty()) {
+        int largest = *max_element(values.begin(), values.end());
+        assert(pq.top() == largest);
+        *find(values.begin(), values.end(), largest) = -1;
+        pq.pop();
+    }
+    assert(*max_element(values.begin(), values.end()) == -1);
+
+    vector<int> vec{ 50, 40, 30, 20, 10 };
+    HEAP<int *, IntPtrComp> pointers;
+    vector<typename HEAP<int *, IntPtrComp>::Node *> handles;
+    for (int &value : vec)
+        handles.push_back(pointers.addNode(&value));
+    vec[0] = 5;
+    pointers.updateElt(handles[0], &vec[0]);
+    vec[2] = 1;
+    pointers.updateElt(handles[2], &vec[2]);
+    for (int expected : { 40, 20, 10, 5, 1 }) {
+        assert(*pointers.top() == expected);
+        pointers.pop();
+    }
+
+    cout << "testPairingErase() succeeded" << endl;
+} // testPairingErase()
+
+
+// Raise the priority of nodes anywhere in the tree: leftmost children, middle
+// and last siblings, and nodes that are not children of the root.
+template<template<typename...> class HEAP>
+void testPairingUpdateElt() {
+    cout << "Testing pairing updateElt" << endl;
+    vector<int> vec(2000);
+    vector<typename HEAP<int *, IntPtrComp>::Node *> nodes;
+    HEAP<int *, IntPtrComp> pq;
+    for (size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = static_cast<int>(i * 7919 % vec.size());
+        nodes.push_back(pq.addNode(&vec[i]));
+    }
+
+    // Pop a few so the root's children get paired up into deeper trees.
+    for (int expected = 1999; expected > 1990; --expected) {
+        assert(*pq.top() == expected);
+        pq.pop();
+    }
+
+    // Every node whose value is still in the heap gets 10000 added to it.
+    int next = 1990;
+    for (size_t i = 0; i < vec.size(); i += 3) {
+        if (vec[i] <= 1990) {
+            vec[i] += 10000;
+            pq.updateElt(nodes[i], &vec[i]);
+            next = max(next, vec[i]);
+            assert(*pq.top() == next);
+        }
+    }
+
+    int previous = *pq.top();
+    size_t popped = 0;
+    while (!pq.empty()) {
+        assert(*pq.top() <= previous);
+        previous = *pq.top();
+        pq.pop();
+        ++popped;
+    }
+    assert(popped == 1991);
+
+    cout << "testPairingUpdateElt() succeeded" << endl;
+} // testPairingUpdateElt()
+
+
+// Scramble every value after the heap has some shape, then rebuild it.
+template<template<typename...> class HEAP>
+void testPairingRebuild() {
+    cout << "Testing pairing updatePriorities on a larger heap" << endl;
+    vector<int> vec(1000);
+    HEAP<int *, IntPtrComp> pq;
+    for (size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = static_cast<int>(i);
+        pq.push(&vec[i]);
+    }
+    pq.pop();
+    pq.pop();
+
+    for (size_t i = 0; i < vec.size(); ++i)
+        vec[i] = static_cast<int>(i * 7919 % vec.size());
+    pq.updatePriorities();
+
+    // vec[998] and vec[999] were popped, so their new values are missing.
+    int previous = *pq.top();
+    size_t popped = 0;
+    while (!pq.empty()) {
+        assert(*pq.top() <= previous);
+        previous = *pq.top();
+        pq.pop();
+        ++popped;
+    }
+    assert(popped == 998);
+
+    cout << "testPairingRebuild() succeeded" << endl;
+} // testPairingRebuild()
+
+
+// Copies must keep working after the original changes, and moves must leave
+// the source empty but usable.
+template<template<typename...> class HEAP>
+void testPairingCopyMove() {
+    cout << "Testing pairing copy and move" << endl;
+    HEAP<int> empty;
+    HEAP<int> empty_copy(empty);
+    assert(empty_copy.empty());
+
+    HEAP<int> original;
+    for (int i = 0; i < 500; ++i)
+        original.push(i * 7919 % 500);
+    original.pop();  // give the tree some shape
+
+    HEAP<int> copy(original);
+    assert(copy.size() == 499);
+    original.pop();
+    original.push(1000);
+    assert(copy.top() == 498);
+    for (int expected = 498; expected >= 0; --expected) {
+        assert(copy.top() == expected);
+        copy.pop();
+    }
+    assert(copy.empty());
+
+    copy = original;
+    copy = copy;
+    assert(copy.size() == 499 && copy.top() == 1000);
+
+    HEAP<int> moved(std::move(copy));
+    assert(moved.size() == 499 && moved.top() == 1000);
+    assert(copy.empty());
+    copy.push(7);
+    assert(copy.top() == 7);
+
+    moved = std::move(copy);
+    assert(moved.size() == 1 && moved.top() == 7);
+    moved.pop();
+    assert(moved.empty());
+
+    cout << "testPairingCopyMove() succeeded" << endl;
+} // testPairingCopyMove()
+
+
+// Merge two heaps and check that handles from both still work afterwards.
+template<template<typename...> class HEAP>
+void testPairingMerge() {
+    cout << "Testing pairing merge" << endl;
+    vector<int> vec(400);
+    vector<typename HEAP<int *, IntPtrComp>::Node *> nodes;
+    HEAP<int *, IntPtrComp> pq1;
+    HEAP<int *, IntPtrComp> pq2;
+    for (size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = static_cast<int>(i);
+        nodes.push_back(i % 2 == 0 ? pq1.addNode(&vec[i]) : pq2.addNode(&vec[i]));
+    }
+    pq2.pop();
+
+    pq1.merge(pq2);
+    assert(pq1.size() == 399 && pq2.empty());
+    assert(*pq1.top() == 398);
+
+    // A handle that came from pq2 is now updated through pq1.
+    vec[1] = 1000;
+    pq1.updateElt(nodes[1], &vec[1]);
+    assert(*pq1.top() == 1000);
+
+    // Merging an empty heap, an rvalue, and into an empty heap.
+    pq1.merge(pq2);
+    pq1.merge(HEAP<int *, IntPtrComp>());
+    assert(pq1.size() == 399);
+    pq2.merge(pq1);
+    assert(pq2.size() == 399 && pq1.empty());
+
+    int previous = *pq2.top();
+    while (!pq2.empty()) {
+        assert(*pq2.top() <= previous);
+        previous = *pq2.top();
+        pq2.pop();
+    }
+
+    cout << "testPairingMerge() succeeded" << endl;
+} // testPairingMerge()
+
+
+// Pop a shuffled range with both pairing strategies and check the order.
+void testPairingStrategies() {
+    cout << "Testing pairing strategies" << endl;
+    vector<int> vec;
+    for (int i = 0; i < 1000; ++i)
+        vec.push_back(i * 7919 % 1000);
+
+    PairingPQ<int> two_pass(vec.begin(), vec.end());
+    PairingPQ<int> multi_pass(vec.begin(), vec.end());
+    multi_pass.setPairingStrategy(PairingPQ<int>::PairingStrategy::MultiPass);
+    for (int expected = 999; expected >= 0; --expected) {
+        assert(two_pass.top() == expected);
+        assert(multi_pass.top() == expected);
+        two_pass.pop();
+        multi_pass.pop();
+        // Interleave some pushes so later pops see deeper trees.
+        if (expected % 100 == 0 && expected > 0) {
+            two_pass.push(-expected);
+            multi_pass.push(-expected);
+        }
+    }
+    assert(two_pass.top() == -100 && multi_pass.top() == -100);
+
+    cout << "testPairingStrategies() succeeded" << endl;
+} // testPairingStrategies()
+
+
+// Promoting a node costs one comparison to find its direction and one with
+// the top, wherever the node is, and pops must still come out in order after
+// many promotions deep in the half-trees.
+void testRankPairingPromotions() {
+    cout << "Testing rank-pairing promotions" << endl;
+    size_t calls = 0;
+    vector<int> vec(3000);
+    using PQ = RankPairingPQ<int *, CountingIntPtrComp>;
+    PQ pq(CountingIntPtrComp{ &calls });
+    vector<PQ::Node *> nodes;
+    for (size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = static_cast<int>(i * 7919 % vec.size());
+        nodes.push_back(pq.addNode(&vec[i]));
+    }
+    // Link everything into deep half-trees, dropping vec[2999].
+    pq.pop();
+
+    vector<int> expected;
+    // Raised values go in new ints, so that updateElt() sees the change.
+    vector<int> raised;
+    raised.reserve(vec.size());
+    for (size_t i = 0; i < vec.size(); ++i) {
+        if (vec[i] == 2999)
+            continue;
+        if (i % 4 == 0) {
+            raised.push_back(10000 + static_cast<int>(i));
+            size_t before = calls;
+            pq.updateElt(nodes[i], &raised.back());
+            assert(calls - before == 2);
+            assert(*pq.top() == raised.back());
+            expected.push_back(raised.back());
+        } else {
+            expected.push_back(vec[i]);
+        }
+    }
+    sort(expected.begin(), expected.end());
+    while (!pq.empty()) {
+        assert(*pq.top() == expected.back());
+        pq.pop();
+        expected.pop_back();
+    }
+
+    cout << "testRankPairingPromotions() succeeded" << endl;
+} // testRankPairingPromotions()
+
+
+// RankPairingPQ runs the PairingPQ tests that do not depend on pairing
+// strategies, plus its own.
+void testRankPairing() {
+    cout << "Testing rank-pairing heap" << endl;
+    vector<int> vec{ 5, 1, 9, 3 };
+    RankPairingPQ<int> ranged(vec.begin(), vec.end());
+    RankPairingPQ<int> assigned;
+    assigned = ranged;
+    ranged.pop();
+    assert(ranged.top() == 5 && assigned.top() == 9 && assigned.size() == 4);
+
+    testPairingStrings<RankPairingPQ>();
+    testPairingUpdateElt<RankPairingPQ>();
+    testPairingErase<RankPairingPQ>();
+    testPairingRebuild<RankPairingPQ>();
+    testPairingCopyMove<RankPairingPQ>();
+    testPairingMerge<RankPairingPQ>();
+    testRankPairingPromotions();
+
+    cout << "testRankPairing() succeeded" << endl;
+} // testRankPairing()
+
+
 // Test the pairing heap's range-based constructor, copy constructor,
 // and operator=().
 //
@@ -258,13 +1810,22 @@ void testPairing(vector<int> & vec) {
     cout << "testPairing() succeeded" << endl;
     
     test_update_pairing();
+    testPairingStrings<PairingPQ>();
+    testPairingStrategies();
+    testPairingUpdateElt<PairingPQ>();
+    testPairingErase<PairingPQ>();
+    testPairingRebuild<PairingPQ>();
+    testPairingCopyMove<PairingPQ>();
+    testPairingMerge<PairingPQ>();
 } // testPairing()
 
 
 int main() {
     // Basic pointer, allocate a new PQ later based on user choice.
     Eecs281PQ<int> *pq;
-    vector<string> types{ "Unordered", "Sorted", "Binary", "Pairing" };
+    vector<string> types{ "Unordered", "Sorted", "Binary", "Pairing", "UnorderedFast", "Dary",
+                          "ChunkedSorted", "IndexedBinary", "MinMax", "Bucket",
+                          "WeakHeap", "RankPairing" };
     unsigned int choice;
 
     cout << "PQ tester" << endl << endl;
@@ -286,6 +1847,30 @@ int main() {
     else if (choice == 3) {
         pq = new PairingPQ<int>;
     } // else if
+    else if (choice == 4) {
+        pq = new UnorderedFastPQ<int>;
+    } // else if
+    else if (choice == 5) {
+        pq = new DaryPQ<int>;
+    } // else if
+    else if (choice == 6) {
+        pq = new ChunkedSortedPQ<int>;
+    } // else if
+    else if (choice == 7) {
+        pq = new IndexedBinaryPQ<int>;
+    } // else if
+    else if (choice == 8) {
+        pq = new MinMaxPQ<int>;
+    } // else if
+    else if (choice == 9) {
+        pq = new BucketPQ<int>;
+    } // else if
+    else if (choice == 10) {
+        pq = new WeakHeapPQ<int>;
+    } // else if
+    else if (choice == 11) {
+        pq = new RankPairingPQ<int>;
+    } // else if
     else {
         cout << "Unknown container!" << endl << endl;
         exit(1);
@@ -293,6 +1878,9 @@ int main() {
    
     testPriorityQueue(pq, types[choice]);
     testUpdatePriorities(types[choice]);
+    testMoves(types[choice]);
+    testMarkDirty(types[choice]);
+    testPopK(types[choice]);
 
     if (choice == 3) {
         vector<int> vec;
@@ -300,6 +1888,46 @@ int main() {
         vec.push_back(1);
         testPairing(vec);
     } // if
+    else if (choice == 0 || choice == 4) {
+        testFindExtreme();
+        if (choice == 4)
+            testUnorderedFastBlocks();
+    } // else if
+    else if (choice == 1) {
+        testSortedBulk();
+        testParallelRebuild<SortedPQ<int>>(types[choice]);
+        testParallelForThrow();
+    } // else if
+    else if (choice == 2) {
+        testBinaryPopModes();
+        testBinaryPushRange();
+        testParallelRebuild<BinaryPQ<int>>(types[choice]);
+        // RadixPQ is not on the menu (its keys are unsigned or floating
+        // point, smallest first), so it is tested along with BinaryPQ.
+        testRadix();
+    } // else if
+    else if (choice == 5) {
+        testDary();
+    } // else if
+    else if (choice == 6) {
+        testChunkedSorted();
+        testParallelRebuild<ChunkedSortedPQ<int>>(types[choice]);
+    } // else if
+    else if (choice == 7) {
+        testIndexedBinary();
+    } // else if
+    else if (choice == 8) {
+        testMinMax();
+    } // else if
+    else if (choice == 9) {
+        testBucket();
+    } // else if
+    else if (choice == 10) {
+        testWeakHeap();
+    } // else if
+    else if (choice == 11) {
+        testRankPairing();
+    } // else if
 
     // Clean up!
     delete pq;